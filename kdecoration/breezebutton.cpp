@@ -7,6 +7,7 @@
  */
 #include "breezebutton.h"
 #include "breeze.h"
+#include "breezebuttoniconcache.h"
 #include "colortools.h"
 #include "geometrytools.h"
 #include "renderdecorationbuttonicon.h"
@@ -22,6 +23,9 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QVariantAnimation>
+#include <QtMath>
+
+#include <cmath>
 
 namespace Breeze
 {
@@ -148,6 +152,7 @@ void Button::paint(QPainter *painter, const QRect &repaintRegion)
     if (!m_buttonPalette) { // this is the case when a spacer button
         return;
     }
+    updateColorInterpolationTables();
     m_titlebarTextPinnedInversion = titlebarTextPinnedInversion();
 
     setDevicePixelRatio(painter);
@@ -286,6 +291,13 @@ void Button::drawIcon(QPainter *painter) const
                                  || (m_devicePixelRatio <= 1.001
                                      && (m_d->buttonBackgroundType() == ButtonBackgroundType::Small
                                          || m_d->internalSettings()->iconSize() < InternalSettings::EnumIconSize::IconLargeMedium)));
+
+        // kde-gtk-config generates svg icons, so these must remain as vector paths; everything else is blitted from the shared icon cache
+        if (!m_isGtkCsdButton) {
+            paintCachedIcon(painter, iconWidth, deviceOffsetDecorationTopLeftToIconTopLeft, forceEvenSquares);
+            return;
+        }
+
         auto [iconRenderer, localRenderingWidth] = RenderDecorationButtonIcon::factory(m_d->internalSettings(),
                                                                                        painter,
                                                                                        false,
@@ -304,6 +316,82 @@ void Button::drawIcon(QPainter *painter) const
     }
 }
 
+//__________________________________________________________________
+void Button::paintCachedIcon(QPainter *painter,
+                             const qreal iconWidth,
+                             const QPointF &deviceOffsetDecorationTopLeftToIconTopLeft,
+                             const bool forceEvenSquares) const
+{
+    // the device transform contains the translation to the icon top-left and the device scale (which is 1 on X11)
+    const QTransform deviceTransform = painter->deviceTransform();
+    const qreal deviceScale = deviceTransform.m22();
+    const qreal deviceIconSize = iconWidth * deviceScale;
+
+    // the renderers snap to whole/half pixels relative to the decoration top-left, so the sub-pixel position of the icon is part of the key
+    const qreal fractionX = deviceOffsetDecorationTopLeftToIconTopLeft.x() - std::floor(deviceOffsetDecorationTopLeftToIconTopLeft.x());
+    const qreal fractionY = deviceOffsetDecorationTopLeftToIconTopLeft.y() - std::floor(deviceOffsetDecorationTopLeftToIconTopLeft.y());
+
+    ButtonIconCacheKey key;
+    key.iconStyle = m_d->internalSettings()->buttonIconStyle();
+    key.buttonType = static_cast<DecorationButtonType>(type());
+    key.checked = isChecked();
+    key.deviceIconSize = qRound(deviceIconSize * 64);
+    key.devicePixelRatio = qRound(m_devicePixelRatio * 1000);
+    key.subPixelOffsetX = qRound(fractionX * ButtonIconCache::SubPixelBuckets) % ButtonIconCache::SubPixelBuckets;
+    key.subPixelOffsetY = qRound(fractionY * ButtonIconCache::SubPixelBuckets) % ButtonIconCache::SubPixelBuckets;
+    key.boldButtonIcons = m_boldButtonIcons;
+    key.forceEvenSquares = forceEvenSquares;
+    key.penWidth = qRound(m_standardScaledCosmeticPenWidth * 1000);
+    key.foregroundColor = m_foregroundColor.rgba();
+
+    const QPointF subPixelOffset(qreal(key.subPixelOffsetX) / ButtonIconCache::SubPixelBuckets, qreal(key.subPixelOffsetY) / ButtonIconCache::SubPixelBuckets);
+
+    // some icon styles draw slightly outside of the icon rect, and the pen overhangs the path, so leave a margin around the icon
+    const int padding = qCeil(m_standardScaledCosmeticPenWidth * 2) + qCeil(deviceIconSize / 8);
+
+    QImage image = ButtonIconCache::self()->icon(key);
+    if (image.isNull()) {
+        const int imageSize = qCeil(deviceIconSize) + 2 * padding + 1;
+        image = QImage(imageSize, imageSize, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        QPainter iconPainter(&image);
+        iconPainter.setRenderHints(QPainter::Antialiasing);
+        iconPainter.setPen(painter->pen());
+        iconPainter.translate(QPointF(padding, padding) + subPixelOffset);
+        iconPainter.scale(deviceScale, deviceScale);
+
+        auto [iconRenderer, localRenderingWidth] = RenderDecorationButtonIcon::factory(m_d->internalSettings(),
+                                                                                       &iconPainter,
+                                                                                       false,
+                                                                                       m_boldButtonIcons,
+                                                                                       m_devicePixelRatio,
+                                                                                       subPixelOffset,
+                                                                                       forceEvenSquares);
+
+        qreal scaleFactor = iconWidth / localRenderingWidth;
+        /*
+        scale painter so that all further rendering is preformed inside QRect( 0, 0, localRenderingWidth, localRenderingWidth )
+        */
+        iconPainter.scale(scaleFactor, scaleFactor);
+
+        iconRenderer->renderIcon(static_cast<DecorationButtonType>(type()), isChecked());
+        iconPainter.end();
+
+        ButtonIconCache::self()->insert(key, image);
+    }
+
+    // the icon was rasterized at subPixelOffset from a whole device pixel, so blit it 1:1 at that whole device pixel
+    const QPointF iconDeviceTopLeft = deviceTransform.map(QPointF(0, 0)) - subPixelOffset;
+    const QPoint imageDeviceTopLeft(qRound(iconDeviceTopLeft.x()) - padding, qRound(iconDeviceTopLeft.y()) - padding);
+
+    painter->save();
+    // remove the world transform and the device scale so that painter co-ordinates are device pixels
+    painter->setWorldTransform((painter->worldTransform().inverted() * deviceTransform).inverted());
+    painter->drawImage(imageDeviceTopLeft, image);
+    painter->restore();
+}
+
 //__________________________________________________________________
 QColor Button::foregroundColor(const bool getNonAnimatedColor) const
 {
@@ -326,14 +414,7 @@ QColor Button::foregroundColor(const bool getNonAnimatedColor) const
             return foregroundPressActiveStateAnimated(active, getNonAnimatedColor);
         }
     } else if (m_animation->state() == QAbstractAnimation::Running && !getNonAnimatedColor) { // button hover animation
-        QColor foregroundNormal = foregroundNormalActiveStateAnimated(active, getNonAnimatedColor);
-        QColor foregroundHover = foregroundHoverActiveStateAnimated(active, getNonAnimatedColor);
-        if (foregroundNormal.isValid() && foregroundHover.isValid()) {
-            return KColorUtils::mix(foregroundNormal, foregroundHover, m_opacity);
-        } else if (foregroundHover.isValid()) {
-            return ColorTools::alphaMix(foregroundHover, m_opacity);
-        } else
-            return QColor();
+        return hoverAnimatedColor(ButtonComponent::Icon, active);
     } else if (isHovered()) {
         return foregroundHoverActiveStateAnimated(active, getNonAnimatedColor);
     } else {
@@ -343,61 +424,17 @@ QColor Button::foregroundColor(const bool getNonAnimatedColor) const
 
 QColor Button::foregroundNormalActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
 {
-    if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->foregroundNormal.isValid() && m_buttonPalette->inactive()->foregroundNormal.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->foregroundNormal,
-                                    m_buttonPalette->active()->foregroundNormal,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->foregroundNormal.isValid() && !m_buttonPalette->inactive()->foregroundNormal.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->foregroundNormal, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->foregroundNormal.isValid() && m_buttonPalette->inactive()->foregroundNormal.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->foregroundNormal, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else {
-            return QColor();
-        }
-    } else {
-        const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->foregroundNormal;
-    }
+    return activeStateAnimatedColor(OverridableButtonColorState::IconNormal, active, getNonAnimatedColor);
 }
 
 QColor Button::foregroundHoverActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
 {
-    if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->foregroundHover.isValid() && m_buttonPalette->inactive()->foregroundHover.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->foregroundHover,
-                                    m_buttonPalette->active()->foregroundHover,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->foregroundHover.isValid() && !m_buttonPalette->inactive()->foregroundHover.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->foregroundHover, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->foregroundHover.isValid() && m_buttonPalette->inactive()->foregroundHover.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->foregroundHover, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else {
-            return QColor();
-        }
-    } else {
-        const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->foregroundHover;
-    }
+    return activeStateAnimatedColor(OverridableButtonColorState::IconHover, active, getNonAnimatedColor);
 }
 
 QColor Button::foregroundPressActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
 {
-    if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->foregroundPress.isValid() && m_buttonPalette->inactive()->foregroundPress.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->foregroundPress,
-                                    m_buttonPalette->active()->foregroundPress,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->foregroundPress.isValid() && !m_buttonPalette->inactive()->foregroundPress.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->foregroundPress, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->foregroundPress.isValid() && m_buttonPalette->inactive()->foregroundPress.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->foregroundPress, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else
-            return QColor();
-    } else {
-        const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->foregroundPress;
-    }
+    return activeStateAnimatedColor(OverridableButtonColorState::IconPress, active, getNonAnimatedColor);
 }
 
 //__________________________________________________________________
@@ -423,14 +460,7 @@ QColor Button::backgroundColor(const bool getNonAnimatedColor) const
             return backgroundPressActiveStateAnimated(active, getNonAnimatedColor);
         }
     } else if (m_animation->state() == QAbstractAnimation::Running && !getNonAnimatedColor) { // button hover animation
-        QColor backgroundNormal = backgroundNormalActiveStateAnimated(active, getNonAnimatedColor);
-        QColor backgroundHover = backgroundHoverActiveStateAnimated(active, getNonAnimatedColor);
-        if (backgroundNormal.isValid() && backgroundHover.isValid()) {
-            return KColorUtils::mix(backgroundNormal, backgroundHover, m_opacity);
-        } else if (backgroundHover.isValid()) {
-            return ColorTools::alphaMix(backgroundHover, m_opacity);
-        } else
-            return QColor();
+        return hoverAnimatedColor(ButtonComponent::Background, active);
     } else if (isHovered()) {
         return backgroundHoverActiveStateAnimated(active, getNonAnimatedColor);
     } else {
@@ -440,61 +470,17 @@ QColor Button::backgroundColor(const bool getNonAnimatedColor) const
 
 QColor Button::backgroundNormalActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
 {
-    if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->backgroundNormal.isValid() && m_buttonPalette->inactive()->backgroundNormal.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->backgroundNormal,
-                                    m_buttonPalette->active()->backgroundNormal,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->backgroundNormal.isValid() && !m_buttonPalette->inactive()->backgroundNormal.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->backgroundNormal, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->backgroundNormal.isValid() && m_buttonPalette->inactive()->backgroundNormal.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->backgroundNormal, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else {
-            return QColor();
-        }
-    } else {
-        const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->backgroundNormal;
-    }
+    return activeStateAnimatedColor(OverridableButtonColorState::BackgroundNormal, active, getNonAnimatedColor);
 }
 
 QColor Button::backgroundHoverActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
 {
-    if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->backgroundHover.isValid() && m_buttonPalette->inactive()->backgroundHover.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->backgroundHover,
-                                    m_buttonPalette->active()->backgroundHover,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->backgroundHover.isValid() && !m_buttonPalette->inactive()->backgroundHover.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->backgroundHover, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->backgroundHover.isValid() && m_buttonPalette->inactive()->backgroundHover.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->backgroundHover, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else {
-            return QColor();
-        }
-    } else {
-        const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->backgroundHover;
-    }
+    return activeStateAnimatedColor(OverridableButtonColorState::BackgroundHover, active, getNonAnimatedColor);
 }
 
 QColor Button::backgroundPressActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
 {
-    if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->backgroundPress.isValid() && m_buttonPalette->inactive()->backgroundPress.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->backgroundPress,
-                                    m_buttonPalette->active()->backgroundPress,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->backgroundPress.isValid() && !m_buttonPalette->inactive()->backgroundPress.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->backgroundPress, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->backgroundPress.isValid() && m_buttonPalette->inactive()->backgroundPress.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->backgroundPress, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else
-            return QColor();
-    } else {
-        const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->backgroundPress;
-    }
+    return activeStateAnimatedColor(OverridableButtonColorState::BackgroundPress, active, getNonAnimatedColor);
 }
 
 // Returns a colour if an outline is to be drawn around the button
@@ -519,14 +505,7 @@ QColor Button::outlineColor(const bool getNonAnimatedColor) const
             return outlinePressActiveStateAnimated(active, getNonAnimatedColor);
         }
     } else if (m_animation->state() == QAbstractAnimation::Running && !getNonAnimatedColor) { // button hover animation
-        QColor outlineHover = outlineHoverActiveStateAnimated(active, getNonAnimatedColor);
-        QColor outlineNormal = outlineNormalActiveStateAnimated(active, getNonAnimatedColor);
-        if (outlineNormal.isValid() && outlineHover.isValid()) {
-            return KColorUtils::mix(outlineNormal, outlineHover, m_opacity);
-        } else if (outlineHover.isValid()) {
-            return ColorTools::alphaMix(outlineHover, m_opacity);
-        } else
-            return QColor();
+        return hoverAnimatedColor(ButtonComponent::Outline, active);
     } else if (isHovered()) {
         return outlineHoverActiveStateAnimated(active, getNonAnimatedColor);
     } else {
@@ -536,61 +515,135 @@ QColor Button::outlineColor(const bool getNonAnimatedColor) const
 
 QColor Button::outlineNormalActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
 {
-    if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->outlineNormal.isValid() && m_buttonPalette->inactive()->outlineNormal.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->outlineNormal,
-                                    m_buttonPalette->active()->outlineNormal,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->outlineNormal.isValid() && !m_buttonPalette->inactive()->outlineNormal.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->outlineNormal, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->outlineNormal.isValid() && m_buttonPalette->inactive()->outlineNormal.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->outlineNormal, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else {
-            return QColor();
-        }
+    return activeStateAnimatedColor(OverridableButtonColorState::OutlineNormal, active, getNonAnimatedColor);
+}
+
+QColor Button::outlineHoverActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
+{
+    return activeStateAnimatedColor(OverridableButtonColorState::OutlineHover, active, getNonAnimatedColor);
+}
+
+QColor Button::outlinePressActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
+{
+    return activeStateAnimatedColor(OverridableButtonColorState::OutlinePress, active, getNonAnimatedColor);
+}
+
+//__________________________________________________________________
+// palette colours in OverridableButtonColorState order
+static constexpr QColor DecorationButtonPaletteGroup::*paletteColors[] = {
+    &DecorationButtonPaletteGroup::foregroundNormal,
+    &DecorationButtonPaletteGroup::foregroundHover,
+    &DecorationButtonPaletteGroup::foregroundPress,
+    &DecorationButtonPaletteGroup::backgroundNormal,
+    &DecorationButtonPaletteGroup::backgroundHover,
+    &DecorationButtonPaletteGroup::backgroundPress,
+    &DecorationButtonPaletteGroup::outlineNormal,
+    &DecorationButtonPaletteGroup::outlineHover,
+    &DecorationButtonPaletteGroup::outlinePress,
+};
+static_assert(std::size(paletteColors) == static_cast<size_t>(OverridableButtonColorState::COUNT));
+
+//* set KLASSY_EXACT_COLOR_MIXING to bypass the quantized interpolation tables, e.g. for pixel-exact screenshot tests
+bool Button::s_exactColorMixing = qEnvironmentVariableIntValue("KLASSY_EXACT_COLOR_MIXING");
+
+//__________________________________________________________________
+QColor Button::activeStateMix(const QColor &inactiveColor, const QColor &activeColor, const qreal activeOpacity)
+{
+    if (activeColor.isValid() && inactiveColor.isValid()) {
+        return KColorUtils::mix(inactiveColor, activeColor, activeOpacity);
+    } else if (activeColor.isValid()) {
+        return ColorTools::alphaMix(activeColor, activeOpacity);
+    } else if (inactiveColor.isValid()) {
+        return ColorTools::alphaMix(inactiveColor, (1.0 - activeOpacity));
     } else {
-        const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->outlineNormal;
+        return QColor();
     }
 }
 
-QColor Button::outlineHoverActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
+//__________________________________________________________________
+QColor Button::hoverMix(const QColor &normalColor, const QColor &hoverColor, const qreal hoverOpacity)
 {
-    if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->outlineHover.isValid() && m_buttonPalette->inactive()->outlineHover.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->outlineHover,
-                                    m_buttonPalette->active()->outlineHover,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->outlineHover.isValid() && !m_buttonPalette->inactive()->outlineHover.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->outlineHover, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->outlineHover.isValid() && m_buttonPalette->inactive()->outlineHover.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->outlineHover, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else {
-            return QColor();
-        }
+    if (normalColor.isValid() && hoverColor.isValid()) {
+        return KColorUtils::mix(normalColor, hoverColor, hoverOpacity);
+    } else if (hoverColor.isValid()) {
+        return ColorTools::alphaMix(hoverColor, hoverOpacity);
     } else {
-        const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->outlineHover;
+        return QColor();
     }
 }
 
-QColor Button::outlinePressActiveStateAnimated(const bool active, const bool getNonAnimatedColor) const
+//__________________________________________________________________
+QColor Button::ColorInterpolationTable::color(const qreal progress) const
+{
+    if (!valid) {
+        return QColor();
+    }
+    return QColor::fromRgba(colors[qBound(0, qRound(progress * ColorInterpolationSteps), ColorInterpolationSteps)]);
+}
+
+//__________________________________________________________________
+void Button::updateColorInterpolationTables()
+{
+    if (!m_buttonPalette || (m_colorTablesPalette == m_buttonPalette && m_colorTablesGeneration == m_buttonPalette->generation())) {
+        return;
+    }
+    m_colorTablesPalette = m_buttonPalette;
+    m_colorTablesGeneration = m_buttonPalette->generation();
+
+    auto fillTable = [](ColorInterpolationTable &table, const auto &mix) {
+        table.valid = mix(0).isValid() || mix(ColorInterpolationSteps).isValid();
+        for (int step = 0; step <= ColorInterpolationSteps && table.valid; step++) {
+            table.colors[step] = mix(step).rgba();
+        }
+    };
+
+    for (size_t state = 0; state < m_activeStateColorTables.size(); state++) {
+        const QColor &inactiveColor = m_buttonPalette->inactive()->*paletteColors[state];
+        const QColor &activeColor = m_buttonPalette->active()->*paletteColors[state];
+        fillTable(m_activeStateColorTables[state], [&](const int step) {
+            return activeStateMix(inactiveColor, activeColor, qreal(step) / ColorInterpolationSteps);
+        });
+    }
+
+    for (size_t component = 0; component < m_hoverColorTables.size(); component++) {
+        for (int active = 0; active < 2; active++) {
+            const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
+            const QColor &normalColor = group->*paletteColors[component * 3];
+            const QColor &hoverColor = group->*paletteColors[component * 3 + 1];
+            fillTable(m_hoverColorTables[component][active], [&](const int step) {
+                return hoverMix(normalColor, hoverColor, qreal(step) / ColorInterpolationSteps);
+            });
+        }
+    }
+}
+
+//__________________________________________________________________
+QColor Button::activeStateAnimatedColor(const OverridableButtonColorState state, const bool active, const bool getNonAnimatedColor) const
 {
     if (!getNonAnimatedColor && m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
-        if (m_buttonPalette->active()->outlinePress.isValid() && m_buttonPalette->inactive()->outlinePress.isValid()) {
-            return KColorUtils::mix(m_buttonPalette->inactive()->outlinePress,
-                                    m_buttonPalette->active()->outlinePress,
-                                    m_d->activeStateChangeAnimationOpacity());
-        } else if (m_buttonPalette->active()->outlinePress.isValid() && !m_buttonPalette->inactive()->outlinePress.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->active()->outlinePress, m_d->activeStateChangeAnimationOpacity());
-        } else if (!m_buttonPalette->active()->outlinePress.isValid() && m_buttonPalette->inactive()->outlinePress.isValid()) {
-            return ColorTools::alphaMix(m_buttonPalette->inactive()->outlinePress, (1.0 - m_d->activeStateChangeAnimationOpacity()));
-        } else
-            return QColor();
+        if (s_exactColorMixing) {
+            return activeStateMix(m_buttonPalette->inactive()->*paletteColors[static_cast<size_t>(state)],
+                                  m_buttonPalette->active()->*paletteColors[static_cast<size_t>(state)],
+                                  m_d->activeStateChangeAnimationOpacity());
+        }
+        return m_activeStateColorTables[static_cast<size_t>(state)].color(m_d->activeStateChangeAnimationOpacity());
     } else {
         const DecorationButtonPaletteGroup *group = active ? m_buttonPalette->active() : m_buttonPalette->inactive();
-        return group->outlinePress;
+        return group->*paletteColors[static_cast<size_t>(state)];
+    }
+}
+
+//__________________________________________________________________
+QColor Button::hoverAnimatedColor(const ButtonComponent component, const bool active) const
+{
+    // both animations running at once is rare, so only the hover axis is tabulated and the combination is mixed exactly
+    if (s_exactColorMixing || m_d->activeStateChangeAnimation()->state() == QAbstractAnimation::Running) {
+        const size_t normalState = static_cast<size_t>(component) * 3;
+        return hoverMix(activeStateAnimatedColor(static_cast<OverridableButtonColorState>(normalState), active),
+                        activeStateAnimatedColor(static_cast<OverridableButtonColorState>(normalState + 1), active),
+                        m_opacity);
     }
+    return m_hoverColorTables[static_cast<size_t>(component)][active ? 1 : 0].color(m_opacity);
 }
 
 bool Button::titlebarTextPinnedInversion() const
@@ -658,6 +711,7 @@ void Button::updateThinWindowOutlineWithButtonColor(bool on)
         if (!m_buttonPalette) {
             return;
         }
+        updateColorInterpolationTables();
         m_titlebarTextPinnedInversion = titlebarTextPinnedInversion();
         color = this->outlineColor(true); // generate colour again in non-animated state
         if (!color.isValid())
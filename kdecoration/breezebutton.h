@@ -15,6 +15,8 @@
 #include <QHash>
 #include <QImage>
 
+#include <array>
+
 class QVariantAnimation;
 
 namespace Breeze
@@ -192,6 +194,12 @@ private:
     //* draw button icon
     void drawIcon(QPainter *) const;
 
+    //* blit the button icon from the shared ButtonIconCache, rendering it into the cache first if necessary
+    void paintCachedIcon(QPainter *painter,
+                         const qreal iconWidth,
+                         const QPointF &deviceOffsetDecorationTopLeftToIconTopLeft,
+                         const bool forceEvenSquares) const;
+
     //*@name colors
     //@{
     QColor backgroundColor(const bool getNonAnimatedColor = false) const;
@@ -210,6 +218,31 @@ private:
     QColor outlineHoverActiveStateAnimated(const bool active, const bool getNonAnimatedColor = false) const;
     QColor outlinePressActiveStateAnimated(const bool active, const bool getNonAnimatedColor = false) const;
 
+    //* number of quantized steps in the precomputed animation colour tables
+    static constexpr int ColorInterpolationSteps = 32;
+
+    //* colours precomputed across one animation axis, indexed by the quantized animation progress
+    struct ColorInterpolationTable {
+        //* false when the mixed colour is invalid at every step
+        bool valid = false;
+        std::array<QRgb, ColorInterpolationSteps + 1> colors{};
+
+        QColor color(const qreal progress) const;
+    };
+
+    //* exact mixes along the active state change and hover animation axes
+    static QColor activeStateMix(const QColor &inactiveColor, const QColor &activeColor, const qreal activeOpacity);
+    static QColor hoverMix(const QColor &normalColor, const QColor &hoverColor, const qreal hoverOpacity);
+
+    //* rebuilds the interpolation tables if m_buttonPalette has been regenerated since they were last filled
+    void updateColorInterpolationTables();
+
+    //* palette colour of a button state with the active state change animation considered
+    QColor activeStateAnimatedColor(const OverridableButtonColorState state, const bool active, const bool getNonAnimatedColor = false) const;
+
+    //* normal to hover colour of a component for the current hover animation progress
+    QColor hoverAnimatedColor(const ButtonComponent component, const bool active) const;
+
     //* sets m_systemIconName and m_systemIconCheckedName
     void configureSystemIcons();
 
@@ -278,6 +311,14 @@ private:
     qreal m_opacity = 0;
 
     DecorationButtonPalette *m_buttonPalette = nullptr;
+
+    //* active state change tables indexed by OverridableButtonColorState
+    std::array<ColorInterpolationTable, static_cast<size_t>(OverridableButtonColorState::COUNT)> m_activeStateColorTables;
+    //* hover tables indexed by ButtonComponent, then by active state
+    std::array<std::array<ColorInterpolationTable, 2>, static_cast<size_t>(ButtonComponent::COUNT)> m_hoverColorTables;
+    const DecorationButtonPalette *m_colorTablesPalette = nullptr;
+    quint64 m_colorTablesGeneration = 0;
+    static bool s_exactColorMixing;
     bool m_renderSystemIcon;
     QString m_systemIconName;
     QString m_systemIconCheckedName;
@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Paul A McAuley <kde@paulmcauley.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "breezebuttoniconcache.h"
+#include "dbusupdatenotifier.h"
+
+#include <QHashFunctions>
+
+namespace Breeze
+{
+
+ButtonIconCache *ButtonIconCache::s_self = nullptr;
+
+//__________________________________________________________________
+size_t qHash(const ButtonIconCacheKey &key, size_t seed)
+{
+    const int flags = (key.checked ? 0x1 : 0) | (key.boldButtonIcons ? 0x2 : 0) | (key.forceEvenSquares ? 0x4 : 0);
+    return qHashMulti(seed,
+                      key.iconStyle,
+                      static_cast<int>(key.buttonType),
+                      flags,
+                      key.deviceIconSize,
+                      key.devicePixelRatio,
+                      key.subPixelOffsetX,
+                      key.subPixelOffsetY,
+                      key.penWidth,
+                      key.foregroundColor);
+}
+
+//__________________________________________________________________
+ButtonIconCache::ButtonIconCache()
+    : m_cache(MaxCost)
+{
+    // any of these can change the colours or shapes of the icons in ways not captured by the key
+    connect(&g_dBusUpdateNotifier, &DBusUpdateNotifier::decorationSettingsUpdate, this, &ButtonIconCache::clear);
+    connect(&g_dBusUpdateNotifier, &DBusUpdateNotifier::systemColorSchemeUpdate, this, &ButtonIconCache::clear);
+    connect(&g_dBusUpdateNotifier, &DBusUpdateNotifier::systemIconsUpdate, this, &ButtonIconCache::clear);
+}
+
+//__________________________________________________________________
+ButtonIconCache *ButtonIconCache::self()
+{
+    if (!s_self) {
+        s_self = new ButtonIconCache();
+    }
+
+    return s_self;
+}
+
+//__________________________________________________________________
+QImage ButtonIconCache::icon(const ButtonIconCacheKey &key)
+{
+    if (QImage *image = m_cache.object(key)) {
+        return *image;
+    }
+    return QImage();
+}
+
+//__________________________________________________________________
+void ButtonIconCache::insert(const ButtonIconCacheKey &key, const QImage &image)
+{
+    // cost is the image size in KiB, rounded up
+    const qsizetype cost = image.sizeInBytes() / 1024 + 1;
+    m_cache.insert(key, new QImage(image), cost);
+}
+
+//__________________________________________________________________
+void ButtonIconCache::clear()
+{
+    m_cache.clear();
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Paul A McAuley <kde@paulmcauley.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#pragma once
+
+#include "breeze.h"
+
+#include <QCache>
+#include <QColor>
+#include <QImage>
+#include <QObject>
+
+namespace Breeze
+{
+
+//* identifies one rasterized titlebar button icon
+struct ButtonIconCacheKey {
+    int iconStyle = 0;
+    DecorationButtonType buttonType = DecorationButtonType::Custom;
+    bool checked = false;
+    //* icon size in device pixels, in 1/64ths of a pixel
+    int deviceIconSize = 0;
+    //* device pixel ratio (also set on X11), in 1/1000ths
+    int devicePixelRatio = 0;
+    //* sub-pixel offset of the icon from a whole device pixel, in units of 1/ButtonIconCache::SubPixelBuckets
+    int subPixelOffsetX = 0;
+    int subPixelOffsetY = 0;
+    bool boldButtonIcons = false;
+    bool forceEvenSquares = false;
+    //* cosmetic pen width in device pixels, in 1/1000ths
+    int penWidth = 0;
+    QRgb foregroundColor = 0;
+
+    bool operator==(const ButtonIconCacheKey &other) const = default;
+};
+
+size_t qHash(const ButtonIconCacheKey &key, size_t seed = 0);
+
+/**
+ * @brief Process-wide cache of pre-rasterized titlebar button icons, shared by all decorations.
+ *        Icons are rendered once per key by RenderDecorationButtonIcon and afterwards only blitted.
+ *        The cache is flushed whenever the decoration settings, colour scheme or icon theme change.
+ */
+class ButtonIconCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    //* singleton
+    static ButtonIconCache *self();
+
+    //* number of sub-pixel offset buckets per device pixel
+    static constexpr int SubPixelBuckets = 4;
+
+    //* returns the cached icon image for key, or a null image if it has not been rendered yet
+    QImage icon(const ButtonIconCacheKey &key);
+
+    //* insert a rendered icon image
+    void insert(const ButtonIconCacheKey &key, const QImage &image);
+
+public Q_SLOTS:
+    //* flush all cached icons
+    void clear();
+
+private:
+    //* constructor
+    ButtonIconCache();
+
+    //* maximum cache size, in KiB
+    static constexpr int MaxCost = 8 * 1024;
+
+    QCache<ButtonIconCacheKey, QImage> m_cache;
+
+    //* singleton
+    static ButtonIconCache *s_self;
+};
+
+}
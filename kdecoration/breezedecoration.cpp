@@ -27,10 +27,12 @@
 #include <KPluginFactory>
 #include <KWindowSystem>
 
+#include <QCache>
 #include <QDBusConnection>
 #include <QDBusMessage>
 #include <QDBusPendingCallWatcher>
 #include <QDBusPendingReply>
+#include <QHashFunctions>
 #include <QPainter>
 #include <QTextStream>
 #include <QTimer>
@@ -122,28 +124,56 @@ namespace Breeze
 {
 
 KSharedConfig::Ptr Decoration::s_kdeGlobalConfig = KSharedConfig::Ptr();
+quint64 Decoration::s_kdeGlobalConfigGeneration = 0;
+bool Decoration::s_kdeGlobalConfigParsed = false;
 
 using KDecoration2::ColorGroup;
 using KDecoration2::ColorRole;
 
 static std::mutex g_setGlobalLookAndFeelOptionsMutex;
 
-// cached shadow values
 static int g_sDecoCount = 0;
-static int g_shadowSizeEnum = InternalSettings::EnumShadowSize::ShadowLarge;
-static int g_shadowStrength = 255;
-static QColor g_shadowColor = Qt::black;
-static qreal g_cornerRadius = 3;
-static qreal g_systemScaleFactor = 1;
-static bool g_hasNoBorders = true;
-static bool g_roundBottomCornersWhenNoBorders = false;
-static int g_thinWindowOutlineStyleActive = 0;
-static int g_thinWindowOutlineStyleInactive = 0;
-static QColor g_thinWindowOutlineColorActive = Qt::black;
-static QColor g_thinWindowOutlineColorInactive = Qt::black;
-static qreal g_thinWindowOutlineThickness = 1;
-static std::shared_ptr<KDecoration2::DecorationShadow> g_sShadow;
-static std::shared_ptr<KDecoration2::DecorationShadow> g_sShadowInactive;
+
+// shadows shared by all decorations, least recently used are evicted first
+static constexpr int g_maxCachedShadows = 32;
+static QCache<ShadowParameters, std::shared_ptr<KDecoration2::DecorationShadow>> g_shadowCache(g_maxCachedShadows);
+
+// blurred shadows without the thin window outline, keyed by ShadowParameters with the outline parameters left at their defaults
+static constexpr int g_maxCachedShadowBodies = 8;
+static QCache<ShadowParameters, QImage> g_shadowBodyCache(g_maxCachedShadowBodies);
+
+// identifies one interpolated frame of the active/inactive shadow animation
+struct ShadowAnimationFrameKey {
+    ShadowParameters inactive;
+    ShadowParameters active;
+    int step = 0;
+
+    bool operator==(const ShadowAnimationFrameKey &other) const = default;
+};
+
+static size_t qHash(const ShadowAnimationFrameKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.inactive, key.active, key.step);
+}
+
+// the active/inactive shadow animation is quantized to this many steps, so its frames can be cached
+static constexpr int g_shadowAnimationSteps = 8;
+static constexpr int g_maxCachedShadowAnimationFrames = 4 * (g_shadowAnimationSteps - 1);
+static QCache<ShadowAnimationFrameKey, std::shared_ptr<KDecoration2::DecorationShadow>> g_shadowAnimationFrameCache(g_maxCachedShadowAnimationFrames);
+
+//________________________________________________________________
+size_t qHash(const ShadowParameters &key, size_t seed)
+{
+    const int flags = (key.squareBottomCorners ? 0x1 : 0) | (key.drawOutline ? 0x2 : 0) | (key.outlineMiterJoin ? 0x4 : 0);
+    return qHashMulti(seed,
+                      key.shadowSize,
+                      key.shadowColor,
+                      key.cornerRadius,
+                      flags,
+                      key.outlineColor,
+                      key.outlinePenWidth,
+                      key.outlineOverlap);
+}
 
 //________________________________________________________________
 Decoration::Decoration(QObject *parent, const QVariantList &args)
@@ -167,11 +197,26 @@ Decoration::~Decoration()
 {
     g_sDecoCount--;
     if (g_sDecoCount == 0) {
-        // last deco destroyed, clean up shadow
-        g_sShadow.reset();
+        // last deco destroyed, clean up shadows
+        g_shadowCache.clear();
+        g_shadowAnimationFrameCache.clear();
+        g_shadowBodyCache.clear();
     }
 }
 
+//________________________________________________________________
+void Decoration::reparseKdeGlobalConfig()
+{
+    // kdeglobals is shared by all decorations, so only reparse it once per settings provider configuration generation
+    const quint64 generation = SettingsProvider::self()->generation();
+    if (s_kdeGlobalConfigParsed && s_kdeGlobalConfigGeneration == generation) {
+        return;
+    }
+    s_kdeGlobalConfig->reparseConfiguration();
+    s_kdeGlobalConfigGeneration = generation;
+    s_kdeGlobalConfigParsed = true;
+}
+
 //________________________________________________________________
 void Decoration::setOpacity(qreal value)
 {
@@ -186,21 +231,12 @@ void Decoration::setOpacity(qreal value)
 QColor Decoration::titleBarColor(bool returnNonAnimatedColor) const
 {
     auto c = client();
-    if (hideTitleBar() && !m_internalSettings->useTitleBarColorForAllBorders())
-        return c->color(ColorGroup::Inactive, ColorRole::TitleBar);
-
-    QColor activeTitleBarColor = m_decorationColors->active()->titleBarBase;
-    QColor inactiveTitlebarColor = m_decorationColors->inactive()->titleBarBase;
-    if (m_internalSettings->opaqueTitleBar() || (m_internalSettings->opaqueMaximizedTitleBars() && c->isMaximized())) {
-        activeTitleBarColor.setAlpha(255);
-        inactiveTitlebarColor.setAlpha(255);
-    }
 
     // do not animate titlebar if there is a tools area/header area as it causes glitches
     if (!m_toolsAreaWillBeDrawn && (m_animation->state() == QAbstractAnimation::Running) && !returnNonAnimatedColor) {
-        return KColorUtils::mix(inactiveTitlebarColor, activeTitleBarColor, m_opacity);
+        return KColorUtils::mix(titleBarStateColor(false), titleBarStateColor(true), m_opacity);
     } else {
-        return c->isActive() ? activeTitleBarColor : inactiveTitlebarColor;
+        return titleBarStateColor(c->isActive());
     }
 }
 
@@ -220,6 +256,20 @@ QColor Decoration::titleBarSeparatorColor() const
         return QColor();
 }
 
+//________________________________________________________________
+QColor Decoration::titleBarStateColor(const bool active) const
+{
+    auto c = client();
+    if (hideTitleBar() && !m_internalSettings->useTitleBarColorForAllBorders())
+        return c->color(ColorGroup::Inactive, ColorRole::TitleBar);
+
+    QColor titleBarColor = active ? m_decorationColors->active()->titleBarBase : m_decorationColors->inactive()->titleBarBase;
+    if (m_internalSettings->opaqueTitleBar() || (m_internalSettings->opaqueMaximizedTitleBars() && c->isMaximized())) {
+        titleBarColor.setAlpha(255);
+    }
+    return titleBarColor;
+}
+
 QColor Decoration::overriddenOutlineColorAnimateIn() const
 {
     QColor color = m_thinWindowOutlineOverride;
@@ -318,15 +368,10 @@ void Decoration::init()
             updateShadow(false, true, true);
     });
 
-    // use DBus connection to update on Klassy configuration change
-    auto dbus = QDBusConnection::sessionBus();
+    // update on global settings change, relayed by the settings provider once it has started a new configuration generation
+    connect(SettingsProvider::self(), &SettingsProvider::globalSettingsChanged, this, &Decoration::reconfigure);
 
-    dbus.connect(QString(),
-                 QStringLiteral("/KGlobalSettings"),
-                 QStringLiteral("org.kde.KGlobalSettings"),
-                 QStringLiteral("notifyChange"),
-                 this,
-                 SLOT(reconfigure()));
+    auto dbus = QDBusConnection::sessionBus();
 
     // Implement tablet mode DBus connection
     dbus.connect(QStringLiteral("org.kde.KWin"),
@@ -354,14 +399,24 @@ void Decoration::init()
 
     updateTitleBar();
     auto s = settings();
+
+    // Borders are recalculated immediately, as KWin lays out the window from them during the same state change.
+    // Everything else is only marked dirty and recomputed once by flushUpdates(), so e.g. a maximize which emits several signals back to back does not
+    // lay out the buttons, titlebar and blur region several times.
     connect(s.get(), &KDecoration2::DecorationSettings::borderSizeChanged, this, &Decoration::recalculateBorders);
-    connect(s.get(), &KDecoration2::DecorationSettings::borderSizeChanged, this, &Decoration::updateBlur); // for the case when a border with transparency
+    connect(s.get(), &KDecoration2::DecorationSettings::borderSizeChanged, this, [this]() {
+        scheduleUpdates(UpdateBlur); // for the case when a border with transparency
+    });
 
     // a change in font might cause the borders to change
     connect(s.get(), &KDecoration2::DecorationSettings::fontChanged, this, &Decoration::recalculateBorders);
-    connect(s.get(), &KDecoration2::DecorationSettings::fontChanged, this, &Decoration::updateBlur); // for the case when a border with transparency
+    connect(s.get(), &KDecoration2::DecorationSettings::fontChanged, this, [this]() {
+        scheduleUpdates(UpdateBlur); // for the case when a border with transparency
+    });
     connect(s.get(), &KDecoration2::DecorationSettings::spacingChanged, this, &Decoration::recalculateBorders);
-    connect(s.get(), &KDecoration2::DecorationSettings::spacingChanged, this, &Decoration::updateBlur); // for the case when a border with transparency
+    connect(s.get(), &KDecoration2::DecorationSettings::spacingChanged, this, [this]() {
+        scheduleUpdates(UpdateBlur | UpdateButtonsGeometry); // blur for the case when a border with transparency
+    });
 
     // color cache update
     // The slot will only update if the UUID has changed, hence preventing unnecessary multiple colour cache updates
@@ -375,11 +430,12 @@ void Decoration::init()
     connect(c, &KDecoration2::DecoratedClient::paletteChanged, this, &Decoration::generateDecorationColorsOnClientPaletteUpdate);
 
     // buttons
-    connect(s.get(), &KDecoration2::DecorationSettings::spacingChanged, this, &Decoration::updateButtonsGeometryDelayed);
     connect(s.get(), &KDecoration2::DecorationSettings::decorationButtonsLeftChanged, this, &Decoration::updateButtonsGeometryDelayed);
     connect(s.get(), &KDecoration2::DecorationSettings::decorationButtonsRightChanged, this, &Decoration::updateButtonsGeometryDelayed);
 
     // full reconfiguration
+    // the settings provider must see the reconfigured signal first to start a new configuration generation
+    SettingsProvider::self()->watchDecorationSettings(s);
     connect(s.get(), &KDecoration2::DecorationSettings::reconfigured, this, &Decoration::reconfigure);
     connect(s.get(), &KDecoration2::DecorationSettings::reconfigured, this, &Decoration::updateButtonsGeometryDelayed);
 
@@ -387,26 +443,34 @@ void Decoration::init()
     connect(c, &KDecoration2::DecoratedClient::maximizedHorizontallyChanged, this, &Decoration::recalculateBorders);
     connect(c, &KDecoration2::DecoratedClient::maximizedVerticallyChanged, this, &Decoration::recalculateBorders);
     connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::recalculateBorders);
-    connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::updateShadowOnShadedChange);
     connect(c, &KDecoration2::DecoratedClient::captionChanged, this, [this]() {
         // update the caption area
+        m_captionValid = false;
         update(titleBar());
     });
+    connect(s.get(), &KDecoration2::DecorationSettings::fontChanged, this, [this]() {
+        m_captionValid = false;
+    });
 
     connect(c, &KDecoration2::DecoratedClient::activeChanged, this, &Decoration::updateAnimationState);
-    connect(c, &KDecoration2::DecoratedClient::activeChanged, this, &Decoration::updateOpaque);
-    connect(c, &KDecoration2::DecoratedClient::activeChanged, this, &Decoration::updateBlur);
-    connect(c, &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::updateTitleBar);
-    connect(c, &KDecoration2::DecoratedClient::widthChanged, this, &Decoration::updateTitleBar);
-    connect(c, &KDecoration2::DecoratedClient::sizeChanged, this, &Decoration::updateBlur);
-
-    connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateTitleBar);
-    connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateOpaque);
-
-    connect(c, &KDecoration2::DecoratedClient::widthChanged, this, &Decoration::updateButtonsGeometry);
-    connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateButtonsGeometry);
-    connect(c, &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::updateButtonsGeometry);
-    connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::updateButtonsGeometry);
+    connect(c, &KDecoration2::DecoratedClient::activeChanged, this, [this]() {
+        scheduleUpdates(UpdateOpaque | UpdateBlur);
+    });
+    connect(c, &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, [this]() {
+        scheduleUpdates(UpdateTitleBar | UpdateButtonsGeometry);
+    });
+    connect(c, &KDecoration2::DecoratedClient::widthChanged, this, [this]() {
+        scheduleUpdates(UpdateTitleBar | UpdateButtonsGeometry);
+    });
+    connect(c, &KDecoration2::DecoratedClient::sizeChanged, this, [this]() {
+        scheduleUpdates(UpdateBlur);
+    });
+    connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, [this]() {
+        scheduleUpdates(UpdateTitleBar | UpdateOpaque | UpdateButtonsGeometry);
+    });
+    connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, [this]() {
+        scheduleUpdates(UpdateShadow | UpdateButtonsGeometry);
+    });
 
     createButtons();
     updateShadow();
@@ -547,7 +611,7 @@ void Decoration::reconfigureMain(const bool noUpdateShadow)
     QPalette clientPalette = c->palette();
     updateDecorationColors(clientPalette);
 
-    s_kdeGlobalConfig->reparseConfiguration();
+    reparseKdeGlobalConfig();
     if (KWindowSystem::isPlatformX11()) {
         // loads system ScaleFactor from ~/.config/kdeglobals
         const KConfigGroup cgKScreen(s_kdeGlobalConfig, QStringLiteral("KScreen"));
@@ -670,7 +734,7 @@ void Decoration::generateDecorationColorsOnClientPaletteUpdate(const QPalette &c
 {
     SettingsProvider::self()->reconfigure();
     m_internalSettings = SettingsProvider::self()->internalSettings(this);
-    s_kdeGlobalConfig->reparseConfiguration();
+    reparseKdeGlobalConfig();
 
     updateDecorationColors(clientPalette);
     reconfigure();
@@ -683,7 +747,7 @@ void Decoration::generateDecorationColorsOnDecorationColorSettingsUpdate(QByteAr
 
     SettingsProvider::self()->reconfigure();
     m_internalSettings = SettingsProvider::self()->internalSettings(this);
-    s_kdeGlobalConfig->reparseConfiguration();
+    reparseKdeGlobalConfig();
 
     updateDecorationColors(clientPalette, uuid);
 }
@@ -695,7 +759,7 @@ void Decoration::generateDecorationColorsOnSystemColorSettingsUpdate(QByteArray
 
     SettingsProvider::self()->reconfigure();
     m_internalSettings = SettingsProvider::self()->internalSettings(this);
-    s_kdeGlobalConfig->reparseConfiguration();
+    reparseKdeGlobalConfig();
 
     updateDecorationColors(clientPalette, uuid);
     reconfigure();
@@ -805,7 +869,53 @@ void Decoration::createButtons()
 //________________________________________________________________
 void Decoration::updateButtonsGeometryDelayed()
 {
-    QTimer::singleShot(0, this, &Decoration::updateButtonsGeometry);
+    scheduleUpdates(UpdateButtonsGeometry);
+}
+
+//________________________________________________________________
+void Decoration::scheduleUpdates(const int categories)
+{
+#if KLASSY_DECORATION_DEBUG_MODE
+    for (int i = 0; i < UpdateCategoryCount; ++i) {
+        if (categories & (1 << i))
+            m_requestedUpdateCounts[i]++;
+    }
+#endif
+
+    if (!m_pendingUpdates) {
+        QTimer::singleShot(0, this, &Decoration::flushUpdates);
+    }
+    m_pendingUpdates |= categories;
+}
+
+//________________________________________________________________
+void Decoration::flushUpdates()
+{
+    const int updates = m_pendingUpdates;
+    m_pendingUpdates = 0;
+
+#if KLASSY_DECORATION_DEBUG_MODE
+    for (int i = 0; i < UpdateCategoryCount; ++i) {
+        if (updates & (1 << i))
+            m_performedUpdateCounts[i]++;
+    }
+    qDebug() << "Klassy: flushing decoration updates" << Qt::hex << updates << Qt::dec << "- requested (titlebar, buttons, opaque, blur, shadow):"
+             << m_requestedUpdateCounts[0] << m_requestedUpdateCounts[1] << m_requestedUpdateCounts[2] << m_requestedUpdateCounts[3]
+             << m_requestedUpdateCounts[4] << "performed:" << m_performedUpdateCounts[0] << m_performedUpdateCounts[1] << m_performedUpdateCounts[2]
+             << m_performedUpdateCounts[3] << m_performedUpdateCounts[4];
+#endif
+
+    // the button layout depends on the titlebar margins, and the blur region on the opaqueness
+    if (updates & UpdateTitleBar)
+        updateTitleBar();
+    if (updates & UpdateButtonsGeometry)
+        updateButtonsGeometry();
+    if (updates & UpdateOpaque)
+        updateOpaque();
+    if (updates & UpdateBlur)
+        updateBlur();
+    if (updates & UpdateShadow)
+        updateShadow();
 }
 
 //________________________________________________________________
@@ -1153,15 +1263,20 @@ void Decoration::paint(QPainter *painter, const QRect &repaintRegion)
 {
     m_painting = true;
 
-    // TODO: optimize based on repaintRegion
     auto c = client();
     auto s = settings();
 
     calculateWindowAndTitleBarShapes();
 
+    // Only paint within repaintRegion, and skip the parts which do not intersect it at all.
+    // A repaint within a single button, e.g. for a hover animation, then only paints the titlebar background behind that button and the button itself.
+    painter->save();
+    painter->setClipRect(repaintRegion, Qt::IntersectClip);
+
     // paint background
-    if (!c->isShaded()) {
-        painter->fillRect(rect(), Qt::transparent);
+    const QRect bordersRect = hideTitleBar() ? rect() : QRect(0, borderTop(), size().width(), size().height() - borderTop());
+    if (!c->isShaded() && bordersRect.intersects(repaintRegion)) {
+        painter->fillRect(repaintRegion, Qt::transparent);
         painter->save();
         painter->setRenderHint(QPainter::Antialiasing);
         painter->setPen(Qt::NoPen);
@@ -1174,13 +1289,9 @@ void Decoration::paint(QPainter *painter, const QRect &repaintRegion)
 
         painter->setBrush(windowBorderColor);
 
-        QPainterPath clipRect;
-        // use clipRect for clipping away the top part
         if (!hideTitleBar()) {
-            clipRect.addRect(0, borderTop(), size().width(), size().height() - borderTop());
-            // clip off the titlebar and draw bottom part
-            QPainterPath windowPathMinusTitleBar = m_windowPath.intersected(clipRect);
-            painter->drawPath(windowPathMinusTitleBar);
+            // draw the bottom part only, the titlebar is painted over it
+            painter->drawPath(m_windowPathMinusTitleBar);
         } else {
             painter->drawPath(m_windowPath);
         }
@@ -1192,7 +1303,8 @@ void Decoration::paint(QPainter *painter, const QRect &repaintRegion)
         paintTitleBar(painter, repaintRegion);
     }
 
-    if (hasBorders() && !s->isAlphaChannelSupported()) {
+    // the frame is only one pixel wide
+    if (hasBorders() && !s->isAlphaChannelSupported() && !rect().adjusted(1, 1, -1, -1).contains(repaintRegion)) {
         painter->save();
         painter->setRenderHint(QPainter::Antialiasing, false);
         painter->setBrush(Qt::NoBrush);
@@ -1202,32 +1314,48 @@ void Decoration::paint(QPainter *painter, const QRect &repaintRegion)
         painter->restore();
     }
 
+    painter->restore();
+
     m_painting = false;
 }
 
-void Decoration::calculateWindowAndTitleBarShapes(const bool windowShapeOnly)
+void Decoration::calculateWindowAndTitleBarShapes()
 {
     auto c = client();
     auto s = settings();
 
-    if (!windowShapeOnly || c->isShaded()) {
-        // set titleBar geometry and path
-        m_titleRect = QRect(QPoint(0, 0), QSize(size().width(), borderTop()));
-        m_titleBarPath.clear(); // clear the path for subsequent calls to this function
-        if (isMaximized() || !s->isAlphaChannelSupported()) {
-            m_titleBarPath.addRect(m_titleRect);
-        } else if (c->isShaded()) {
-            m_titleBarPath.addRoundedRect(m_titleRect, m_scaledCornerRadius, m_scaledCornerRadius);
-        } else {
-            m_titleBarPath = GeometryTools::roundedPath(m_titleRect, CornersTop, m_scaledCornerRadius);
-        }
+    WindowShapeKey key;
+    key.size = size();
+    key.borderTop = borderTop();
+    key.cornerRadius = m_scaledCornerRadius;
+    key.maximized = isMaximized();
+    key.shaded = c->isShaded();
+    key.alphaChannelSupported = s->isAlphaChannelSupported();
+    key.squareBottomCorners = hasNoBorders() && !m_internalSettings->roundBottomCornersWhenNoBorders();
+
+    // the paths are only rebuilt when something they depend on has changed
+    if (m_windowShapeValid && key == m_windowShapeKey) {
+        return;
+    }
+    m_windowShapeKey = key;
+    m_windowShapeValid = true;
+
+    // set titleBar geometry and path
+    m_titleRect = QRect(QPoint(0, 0), QSize(size().width(), borderTop()));
+    m_titleBarPath.clear(); // clear the path for subsequent calls to this function
+    if (isMaximized() || !s->isAlphaChannelSupported()) {
+        m_titleBarPath.addRect(m_titleRect);
+    } else if (c->isShaded()) {
+        m_titleBarPath.addRoundedRect(m_titleRect, m_scaledCornerRadius, m_scaledCornerRadius);
+    } else {
+        m_titleBarPath = GeometryTools::roundedPath(m_titleRect, CornersTop, m_scaledCornerRadius);
     }
 
     // set windowPath
     m_windowPath.clear(); // clear the path for subsequent calls to this function
     if (!c->isShaded()) {
         if (s->isAlphaChannelSupported() && !isMaximized()) {
-            if (hasNoBorders() && !m_internalSettings->roundBottomCornersWhenNoBorders()) { // round at top, square at bottom
+            if (key.squareBottomCorners) { // round at top, square at bottom
                 m_windowPath = GeometryTools::roundedPath(rect(), CornersTop, m_scaledCornerRadius);
             } else {
                 m_windowPath.addRoundedRect(rect(), m_scaledCornerRadius, m_scaledCornerRadius);
@@ -1238,6 +1366,14 @@ void Decoration::calculateWindowAndTitleBarShapes(const bool windowShapeOnly)
     } else { // shaded
         m_windowPath = m_titleBarPath;
     }
+
+    // set the window path with the titlebar clipped off, for painting the borders
+    m_windowPathMinusTitleBar.clear();
+    if (!c->isShaded()) {
+        QPainterPath clipRect;
+        clipRect.addRect(0, borderTop(), size().width(), size().height() - borderTop());
+        m_windowPathMinusTitleBar = m_windowPath.intersected(clipRect);
+    }
 }
 
 //________________________________________________________________
@@ -1249,61 +1385,173 @@ void Decoration::paintTitleBar(QPainter *painter, const QRect &repaintRegion)
         return;
     }
 
-    painter->save();
-    painter->setPen(Qt::NoPen);
+    auto s = settings();
+
+    // The titlebar background and separator of each state are rendered once into an image.
+    // The active state change animation crossfades the two images, adding their premultiplied pixels weighted by the animation progress so the
+    // result is the linear interpolation of both states. The titlebar area is transparent beforehand as the borders are painted below it.
+    // Do not animate the titlebar if there is a tools area/header area as it causes glitches.
+    if (!m_toolsAreaWillBeDrawn && (m_animation->state() == QAbstractAnimation::Running)) {
+        const QImage &inactiveImage = titleBarImage(false, painter);
+        const QImage &activeImage = titleBarImage(true, painter);
+
+        painter->save();
+        painter->setCompositionMode(QPainter::CompositionMode_Plus);
+        painter->setOpacity(1.0 - m_opacity);
+        painter->drawImage(m_titleRect.topLeft(), inactiveImage);
+        painter->setOpacity(m_opacity);
+        painter->drawImage(m_titleRect.topLeft(), activeImage);
+        painter->restore();
+    } else {
+        painter->drawImage(m_titleRect.topLeft(), titleBarImage(c->isActive(), painter));
+
+        // the other state is only needed again for the next active state change
+        m_titleBarImages[c->isActive() ? 0 : 1] = QImage();
+
+        // with a tools area only the separator follows the active state change animation, so it is not part of the image
+        if (m_toolsAreaWillBeDrawn) {
+            const QColor separatorColor(titleBarSeparatorColor());
+            const int separatorHeight(titleBarSeparatorHeight());
+            if (separatorHeight && separatorColor.isValid()
+                && QRect(0, m_titleRect.bottom() - separatorHeight - 1, m_titleRect.width(), separatorHeight + 3).intersects(repaintRegion)) {
+                const bool insetSeparator(m_internalSettings->useTitleBarColorForAllBorders());
+                paintTitleBarSeparator(painter,
+                                       separatorColor,
+                                       separatorHeight,
+                                       qRound(devicePixelRatio(painter)),
+                                       insetSeparator ? borderLeft() : 0,
+                                       insetSeparator ? borderRight() : 0);
+            }
+        }
+    }
+
+    // draw caption, unless only other parts of the titlebar such as a button are repainted
+    const auto cR = captionRect();
+    if (QRect(cR.first.left(), m_titleRect.top(), cR.first.width(), m_titleRect.height()).intersects(repaintRegion)) {
+        painter->setFont(s->font());
+        painter->setPen(fontColor());
+
+        // eliding and shaping the caption is only done when it changes, other repaints just draw the prepared glyphs
+        CaptionKey captionKey;
+        captionKey.caption = c->caption();
+        captionKey.font = s->font();
+        captionKey.width = cR.first.width();
+        captionKey.alignment = cR.second;
+        if (!m_captionValid || !(captionKey == m_captionKey)) {
+            QString caption = captionKey.caption;
+            caption.replace(QLatin1Char('\n'), QLatin1Char(' ')); // as for Qt::TextSingleLine
+            m_caption.setTextFormat(Qt::PlainText);
+            m_caption.setPerformanceHint(QStaticText::AggressiveCaching);
+            m_caption.setText(painter->fontMetrics().elidedText(caption, Qt::ElideMiddle, captionKey.width));
+            m_captionKey = captionKey;
+            m_captionValid = true;
+        }
+
+        // position the caption as drawText() would align it within the caption rect
+        const QSizeF captionSize = m_caption.size();
+        QPointF captionPosition(cR.first.topLeft());
+        if (cR.second & Qt::AlignHCenter) {
+            captionPosition.rx() += (cR.first.width() - captionSize.width()) / 2;
+        } else if (cR.second & Qt::AlignRight) {
+            captionPosition.rx() += cR.first.width() - captionSize.width();
+        }
+        if (cR.second & Qt::AlignVCenter) {
+            captionPosition.ry() += (cR.first.height() - captionSize.height()) / 2;
+        } else if (cR.second & Qt::AlignBottom) {
+            captionPosition.ry() += cR.first.height() - captionSize.height();
+        }
+        painter->drawStaticText(captionPosition, m_caption);
+    }
+
+    // draw all buttons
+    m_leftButtons->paint(painter, repaintRegion);
+    m_rightButtons->paint(painter, repaintRegion);
+}
+
+//________________________________________________________________
+const QImage &Decoration::titleBarImage(const bool active, QPainter *painter)
+{
+    TitleBarImageKey key;
+    key.shape = m_windowShapeKey;
+    key.devicePixelRatio = painter->device()->devicePixelRatioF();
+    key.separatorPenWidth = qRound(devicePixelRatio(painter));
+    key.color = titleBarStateColor(active).rgba();
+    key.gradient = active && m_internalSettings->drawBackgroundGradient();
+
+    // the separator is only drawn for the active state, and painted separately by paintTitleBar() when there is a tools area
+    const QColor separatorColor =
+        active && !m_toolsAreaWillBeDrawn && m_internalSettings->drawTitleBarSeparator() ? m_decorationColors->active()->buttonFocus : QColor();
+    key.separatorHeight = separatorColor.isValid() ? titleBarSeparatorHeight() : 0;
+    if (key.separatorHeight) {
+        key.separatorColor = separatorColor.rgba();
+        if (m_internalSettings->useTitleBarColorForAllBorders()) {
+            key.separatorLeftInset = borderLeft();
+            key.separatorRightInset = borderRight();
+        }
+    }
 
-    QColor titleBarColor(this->titleBarColor());
+    QImage &image = m_titleBarImages[active ? 1 : 0];
+    if (!image.isNull() && key == m_titleBarImageKeys[active ? 1 : 0]) {
+        return image;
+    }
+    m_titleBarImageKeys[active ? 1 : 0] = key;
+
+    image = QImage(m_titleRect.size() * key.devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(key.devicePixelRatio);
+    image.fill(Qt::transparent);
+
+    QPainter imagePainter(&image);
+    imagePainter.setRenderHints(painter->renderHints());
+    imagePainter.translate(-m_titleRect.topLeft());
+    imagePainter.setPen(Qt::NoPen);
+
+    const QColor titleBarColor = QColor::fromRgba(key.color);
 
     // render a linear gradient on title area
-    if (c->isActive() && m_internalSettings->drawBackgroundGradient()) {
+    if (key.gradient) {
         QLinearGradient gradient(0, 0, 0, m_titleRect.height());
         gradient.setColorAt(0.0, titleBarColor.lighter(120));
         gradient.setColorAt(0.8, titleBarColor);
-        painter->setBrush(gradient);
+        imagePainter.setBrush(gradient);
 
     } else {
-        painter->setBrush(titleBarColor);
+        imagePainter.setBrush(titleBarColor);
     }
 
-    auto s = settings();
-
-    painter->drawPath(m_titleBarPath);
+    imagePainter.drawPath(m_titleBarPath);
 
     // draw titlebar separator
-    const QColor titleBarSeparatorColor(this->titleBarSeparatorColor());
-    int separatorHeight;
-    if ((separatorHeight = titleBarSeparatorHeight()) && titleBarSeparatorColor.isValid()) {
-        // outline
-        painter->setRenderHint(QPainter::Antialiasing);
-        painter->setBrush(Qt::NoBrush);
-        QPen p(titleBarSeparatorColor);
-        p.setWidthF(qRound(devicePixelRatio(painter)));
-        p.setCosmetic(true);
-        p.setCapStyle(Qt::FlatCap);
-        painter->setPen(p);
-
-        QRectF titleRectF(m_titleRect); // use a QRectF because QRects have quirks when getting their corner positions
-        qreal separatorYCoOrd = qreal(titleRectF.bottom()) - qreal(separatorHeight) / 2;
-        if (m_internalSettings->useTitleBarColorForAllBorders()) {
-            painter->drawLine(QPointF(titleRectF.bottomLeft().x() + borderLeft(), separatorYCoOrd),
-                              QPointF(titleRectF.bottomRight().x() - borderRight(), separatorYCoOrd));
-        } else {
-            painter->drawLine(QPointF(titleRectF.bottomLeft().x(), separatorYCoOrd), QPointF(titleRectF.bottomRight().x(), separatorYCoOrd));
-        }
+    if (key.separatorHeight) {
+        paintTitleBarSeparator(&imagePainter, separatorColor, key.separatorHeight, key.separatorPenWidth, key.separatorLeftInset, key.separatorRightInset);
     }
 
-    painter->restore();
+    return image;
+}
 
-    // draw caption
-    painter->setFont(s->font());
-    painter->setPen(fontColor());
-    const auto cR = captionRect();
-    const QString caption = painter->fontMetrics().elidedText(c->caption(), Qt::ElideMiddle, cR.first.width());
-    painter->drawText(cR.first, cR.second | Qt::TextSingleLine, caption);
+//________________________________________________________________
+void Decoration::paintTitleBarSeparator(QPainter *painter,
+                                        const QColor &color,
+                                        const int separatorHeight,
+                                        const qreal penWidth,
+                                        const int leftInset,
+                                        const int rightInset) const
+{
+    painter->save();
 
-    // draw all buttons
-    m_leftButtons->paint(painter, repaintRegion);
-    m_rightButtons->paint(painter, repaintRegion);
+    // outline
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setBrush(Qt::NoBrush);
+    QPen p(color);
+    p.setWidthF(penWidth);
+    p.setCosmetic(true);
+    p.setCapStyle(Qt::FlatCap);
+    painter->setPen(p);
+
+    QRectF titleRectF(m_titleRect); // use a QRectF because QRects have quirks when getting their corner positions
+    qreal separatorYCoOrd = qreal(titleRectF.bottom()) - qreal(separatorHeight) / 2;
+    painter->drawLine(QPointF(titleRectF.bottomLeft().x() + leftInset, separatorYCoOrd), QPointF(titleRectF.bottomRight().x() - rightInset, separatorYCoOrd));
+
+    painter->restore();
 }
 
 // outputs the icon size + padding to make a small button, the actual icon size, and the background size to make a small button
@@ -1485,72 +1733,128 @@ void Decoration::updateShadow(const bool forceUpdateCache, bool noCache, const b
         return;
     }
 
-    // The preset exception may modify the shadow, so in this case there is a "noCache" property set - we don't want to cache the exception shadow as it may
-    // corrupt the shadow cache for normal non-exception decoration windows For shaded windows the shadow/outline has a potentially different shape so do not
-    // use the shadow cache when shaded
-    if (m_internalSettings->property("noCacheException").toBool() || c->isShaded()) {
-        noCache = true;
-    }
-
-    // Animated case, no cached shadow object
+    // Animated case
     if ((m_shadowAnimation->state() == QAbstractAnimation::Running) && (m_shadowOpacity != 0.0) && (m_shadowOpacity != 1.0)) {
-        QColor shadowColor = KColorUtils::mix(m_decorationColors->inactive()->shadow, m_decorationColors->active()->shadow, m_shadowOpacity);
         setThinWindowOutlineColor();
-        setShadow(createShadowObject(shadowColor, isThinWindowOutlineOverride));
+
+        // the frames are interpolated between the cached active and inactive shadows, except when the outline is overridden with a button colour
+        if (!isThinWindowOutlineOverride && !m_thinWindowOutlineOverride.isValid() && !m_animateOutOverriddenThinWindowOutline) {
+            const ShadowParameters inactiveParams =
+                shadowParameters(m_decorationColors->inactive()->shadow, m_decorationColors->inactive()->windowOutline, isThinWindowOutlineOverride);
+            const ShadowParameters activeParams =
+                shadowParameters(m_decorationColors->active()->shadow, m_decorationColors->active()->windowOutline, isThinWindowOutlineOverride);
+
+            if (std::shared_ptr<KDecoration2::DecorationShadow> shadow = shadowAnimationFrame(inactiveParams, activeParams)) {
+                setShadow(shadow);
+                return;
+            }
+        }
+
+        // no cached shadow object, render a new shadow on every frame with the analytic renderer which is much cheaper than blurring
+        QColor shadowColor = KColorUtils::mix(m_decorationColors->inactive()->shadow, m_decorationColors->active()->shadow, m_shadowOpacity);
+        setShadow(createShadowObject(shadowParameters(shadowColor, m_thinWindowOutline, isThinWindowOutlineOverride), true));
         return;
     }
     setThinWindowOutlineColor();
 
-    // TODO: Potentially make the kdecoration configwidget more intelligent and send a dbus signal which is aware of whether to update the shadow or not, so
-    // there is less processing here
-    // check if cached settings have changed, if so replace them with new settings values and regenerate the shadow cache
-    if (!noCache
-        && (
-
-            forceUpdateCache || g_shadowSizeEnum != m_internalSettings->shadowSize() || g_shadowStrength != m_internalSettings->shadowStrength()
-            || g_shadowColor != m_internalSettings->shadowColor() || !(qAbs(g_cornerRadius - m_scaledCornerRadius) < 0.001)
-            || !(qAbs(g_systemScaleFactor - m_systemScaleFactorX11) < 0.001) || g_hasNoBorders != hasNoBorders()
-            || g_roundBottomCornersWhenNoBorders != m_internalSettings->roundBottomCornersWhenNoBorders()
-            || g_thinWindowOutlineStyleActive != m_internalSettings->thinWindowOutlineStyle(true)
-            || g_thinWindowOutlineStyleInactive != m_internalSettings->thinWindowOutlineStyle(false)
-            || (c->isActive() ? g_thinWindowOutlineColorActive != m_thinWindowOutline : g_thinWindowOutlineColorInactive != m_thinWindowOutline)
-            || g_thinWindowOutlineThickness != m_internalSettings->thinWindowOutlineThickness())) {
-        g_sShadow.reset();
-        g_sShadowInactive.reset();
-        g_shadowSizeEnum = m_internalSettings->shadowSize();
-        g_shadowStrength = m_internalSettings->shadowStrength();
-        g_shadowColor = m_internalSettings->shadowColor();
-        g_cornerRadius = m_scaledCornerRadius;
-        g_systemScaleFactor = m_systemScaleFactorX11;
-        g_hasNoBorders = hasNoBorders();
-        g_roundBottomCornersWhenNoBorders = m_internalSettings->roundBottomCornersWhenNoBorders();
-        g_thinWindowOutlineStyleActive = m_internalSettings->thinWindowOutlineStyle(true);
-        g_thinWindowOutlineStyleInactive = m_internalSettings->thinWindowOutlineStyle(false);
-        c->isActive() ? g_thinWindowOutlineColorActive = m_thinWindowOutline : g_thinWindowOutlineColorInactive = m_thinWindowOutline;
-        g_thinWindowOutlineThickness = m_internalSettings->thinWindowOutlineThickness();
-    }
-
-    std::shared_ptr<KDecoration2::DecorationShadow> nonCachedShadow;
-    std::shared_ptr<KDecoration2::DecorationShadow> *shadow = nullptr;
-
-    if (noCache)
-        shadow = &nonCachedShadow;
-    else // use the already cached shadow
-        shadow = (c->isActive()) ? &g_sShadow : &g_sShadowInactive;
-
-    if (!(*shadow)) { // only recreate the shadow if necessary
-        QColor shadowColor = c->isActive() ? m_decorationColors->active()->shadow : m_decorationColors->inactive()->shadow;
-        *shadow = createShadowObject(shadowColor, isThinWindowOutlineOverride);
-    }
-
-    setShadow(*shadow);
+    QColor shadowColor = c->isActive() ? m_decorationColors->active()->shadow : m_decorationColors->inactive()->shadow;
+    const ShadowParameters params = shadowParameters(shadowColor, m_thinWindowOutline, isThinWindowOutlineOverride);
+
+    if (params.isNone()) {
+        setShadow(nullptr);
+        return;
+    }
+
+    // The cache key contains every parameter that affects the rendered shadow, so preset exceptions, shaded windows, and windows with differing corner radii
+    // or scale factors all share the one cache without corrupting each others' shadows.
+    // noCache is only set for animation frames of the thin window outline, whose transient colours would just churn the cache.
+    if (forceUpdateCache) {
+        g_shadowCache.remove(params);
+        g_shadowBodyCache.clear();
+        // the animation frames are interpolated from shadows which may no longer match their keys
+        g_shadowAnimationFrameCache.clear();
+    }
+
+    if (noCache && !g_shadowCache.contains(params)) {
+        setShadow(createShadowObject(params));
+        return;
+    }
+
+    setShadow(cachedShadowObject(params));
+}
+
+//________________________________________________________________
+std::shared_ptr<KDecoration2::DecorationShadow> Decoration::cachedShadowObject(const ShadowParameters &params)
+{
+    if (std::shared_ptr<KDecoration2::DecorationShadow> *cachedShadow = g_shadowCache.object(params)) {
+        return *cachedShadow;
+    }
+
+    std::shared_ptr<KDecoration2::DecorationShadow> shadow = createShadowObject(params);
+    g_shadowCache.insert(params, new std::shared_ptr<KDecoration2::DecorationShadow>(shadow));
+    return shadow;
 }
 
 //________________________________________________________________
-std::shared_ptr<KDecoration2::DecorationShadow> Decoration::createShadowObject(QColor shadowColor, const bool isThinWindowOutlineOverride)
+std::shared_ptr<KDecoration2::DecorationShadow> Decoration::shadowAnimationFrame(const ShadowParameters &inactiveParams, const ShadowParameters &activeParams)
+{
+    if (inactiveParams.isNone() || activeParams.isNone()) {
+        return nullptr;
+    }
+
+    const int step = qRound(m_shadowOpacity * g_shadowAnimationSteps);
+    if (step <= 0) {
+        return cachedShadowObject(inactiveParams);
+    } else if (step >= g_shadowAnimationSteps) {
+        return cachedShadowObject(activeParams);
+    }
+
+    const ShadowAnimationFrameKey key{inactiveParams, activeParams, step};
+    if (std::shared_ptr<KDecoration2::DecorationShadow> *cachedFrame = g_shadowAnimationFrameCache.object(key)) {
+        return *cachedFrame;
+    }
+
+    const std::shared_ptr<KDecoration2::DecorationShadow> inactiveShadow = cachedShadowObject(inactiveParams);
+    const std::shared_ptr<KDecoration2::DecorationShadow> activeShadow = cachedShadowObject(activeParams);
+
+    QImage inactiveImage = inactiveShadow->shadow();
+    QImage activeImage = activeShadow->shadow();
+
+    // both endpoints share their geometry unless something other than the colours differs, e.g. while the corner radius changes
+    if (inactiveShadow->padding() != activeShadow->padding() || inactiveShadow->innerShadowRect() != activeShadow->innerShadowRect()
+        || inactiveImage.size() != activeImage.size()) {
+        return nullptr;
+    }
+
+    inactiveImage.convertTo(QImage::Format_ARGB32_Premultiplied);
+    activeImage.convertTo(QImage::Format_ARGB32_Premultiplied);
+
+    // interpolate the premultiplied channels of every pixel, rounding to nearest
+    QImage frameImage(inactiveImage.size(), QImage::Format_ARGB32_Premultiplied);
+    const uchar *inactiveBits = inactiveImage.constBits();
+    const uchar *activeBits = activeImage.constBits();
+    uchar *frameBits = frameImage.bits();
+    const int inactiveWeight = g_shadowAnimationSteps - step;
+    for (qsizetype i = 0; i < frameImage.sizeInBytes(); ++i) {
+        frameBits[i] = (inactiveBits[i] * inactiveWeight + activeBits[i] * step + g_shadowAnimationSteps / 2) / g_shadowAnimationSteps;
+    }
+
+    auto frame = std::make_shared<KDecoration2::DecorationShadow>();
+    frame->setPadding(inactiveShadow->padding());
+    frame->setInnerShadowRect(inactiveShadow->innerShadowRect());
+    frame->setShadow(frameImage);
+
+    g_shadowAnimationFrameCache.insert(key, new std::shared_ptr<KDecoration2::DecorationShadow>(frame));
+    return frame;
+}
+
+//________________________________________________________________
+ShadowParameters Decoration::shadowParameters(const QColor &shadowColor, const QColor &outlineColor, const bool isThinWindowOutlineOverride) const
 {
     auto c = client();
 
+    ShadowParameters params;
+
     // determine when a window outline does not need to be drawn (even when set to none, sometimes needs to be drawn if there is an animation)
     bool windowOutlineNone =
         ((m_internalSettings->thinWindowOutlineStyle(true) == InternalSettings::EnumThinWindowOutlineStyle::WindowOutlineNone
@@ -1559,19 +1863,69 @@ std::shared_ptr<KDecoration2::DecorationShadow> Decoration::createShadowObject(Q
              && ((c->isActive() && m_internalSettings->thinWindowOutlineStyle(true) == InternalSettings::EnumThinWindowOutlineStyle::WindowOutlineNone)
                  || (!c->isActive() && m_internalSettings->thinWindowOutlineStyle(false) == InternalSettings::EnumThinWindowOutlineStyle::WindowOutlineNone))));
 
-    if (m_internalSettings->shadowSize() == InternalSettings::EnumShadowSize::ShadowNone && windowOutlineNone && !isThinWindowOutlineOverride) {
-        return nullptr;
+    params.shadowSize = m_internalSettings->shadowSize();
+    params.noOutline = windowOutlineNone && !isThinWindowOutlineOverride;
+    params.shadowColor = shadowColor.rgba();
+    params.cornerRadius = m_scaledCornerRadius;
+    params.squareBottomCorners = hasNoBorders() && !m_internalSettings->roundBottomCornersWhenNoBorders() && !c->isShaded();
+
+    params.drawOutline = !params.noOutline && outlineColor.isValid();
+    if (params.drawOutline) {
+        params.outlineColor = outlineColor.rgba();
+        params.outlinePenWidth = m_internalSettings->thinWindowOutlineThickness();
+
+        // the overlap between the thin window outline and behind the window in unscaled pixels.
+        // This is necessary for the thin window outline to sit flush with the window on Wayland,
+        // and also makes sure that the anti-aliasing blends properly between the window and thin window outline
+        params.outlineOverlap = 0.5;
+
+        // scale outline
+        // We can't get the DPR for Wayland from KDecoration/KWin but can work around this as Wayland will auto-scale if you don't use a cosmetic pen. On
+        // X11 this does not happen but we can use the system-set scaling value directly.
+        if (KWindowSystem::isPlatformX11()) {
+            params.outlinePenWidth *= m_systemScaleFactorX11;
+            params.outlineOverlap *= m_systemScaleFactorX11;
+        }
+
+        // use a miter join rather than the default bevel join to get sharp corners at low radii
+        params.outlineMiterJoin = m_internalSettings->windowCornerRadius() < 0.4;
     }
 
-    const CompositeShadowParams params = lookupShadowParams(m_internalSettings->shadowSize());
+    return params;
+}
+
+//________________________________________________________________
+static QSize shadowBoxSize(const CompositeShadowParams &params)
+{
+    return BoxShadowRenderer::calculateMinimumBoxSize(params.shadow1.radius).expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(params.shadow2.radius));
+}
+
+//________________________________________________________________
+// the rect of the shadow texture covered by the window, as the window's extent from the texture edges
+static QMargins shadowPadding(const QRect &outerRect, const CompositeShadowParams &params)
+{
+    QRect boxRect(QPoint(0, 0), shadowBoxSize(params));
+    boxRect.moveCenter(outerRect.center());
+
+    return QMargins(boxRect.left() - outerRect.left() - Metrics::Decoration_Shadow_Overlap - params.offset.x(),
+                    boxRect.top() - outerRect.top() - Metrics::Decoration_Shadow_Overlap - params.offset.y(),
+                    outerRect.right() - boxRect.right() - Metrics::Decoration_Shadow_Overlap + params.offset.x(),
+                    outerRect.bottom() - boxRect.bottom() - Metrics::Decoration_Shadow_Overlap + params.offset.y());
+}
 
-    const QSize boxSize =
-        BoxShadowRenderer::calculateMinimumBoxSize(params.shadow1.radius).expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(params.shadow2.radius));
+//________________________________________________________________
+// renders the blurred shadow with the window area masked out, but without the thin window outline
+static QImage renderShadowBody(const ShadowParameters &shadowParams, const bool analytic)
+{
+    const QColor shadowColor = QColor::fromRgba(shadowParams.shadowColor);
+    const CompositeShadowParams params = lookupShadowParams(shadowParams.shadowSize);
 
     BoxShadowRenderer shadowRenderer;
 
-    shadowRenderer.setBorderRadius(m_scaledCornerRadius + 0.5);
-    shadowRenderer.setBoxSize(boxSize);
+    if (analytic)
+        shadowRenderer.setMode(BoxShadowRenderer::Mode::Analytic);
+    shadowRenderer.setBorderRadius(shadowParams.cornerRadius + 0.5);
+    shadowRenderer.setBoxSize(shadowBoxSize(params));
     shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius, ColorTools::alphaMix(shadowColor, params.shadow1.opacity));
     shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius, ColorTools::alphaMix(shadowColor, params.shadow2.opacity));
 
@@ -1581,85 +1935,96 @@ std::shared_ptr<KDecoration2::DecorationShadow> Decoration::createShadowObject(Q
     painter.setRenderHint(QPainter::Antialiasing);
 
     const QRect outerRect = shadowTexture.rect();
-
-    QRect boxRect(QPoint(0, 0), boxSize);
-    boxRect.moveCenter(outerRect.center());
+    const QRectF innerRect = outerRect - shadowPadding(outerRect, params);
 
     // Mask out inner rect.
-    const QMargins padding = QMargins(boxRect.left() - outerRect.left() - Metrics::Decoration_Shadow_Overlap - params.offset.x(),
-                                      boxRect.top() - outerRect.top() - Metrics::Decoration_Shadow_Overlap - params.offset.y(),
-                                      outerRect.right() - boxRect.right() - Metrics::Decoration_Shadow_Overlap + params.offset.x(),
-                                      outerRect.bottom() - boxRect.bottom() - Metrics::Decoration_Shadow_Overlap + params.offset.y());
-    const QRectF innerRect = outerRect - padding;
-
     painter.setPen(Qt::NoPen);
     painter.setBrush(Qt::black);
     painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
 
     QPainterPath roundedRectMask;
-    if (hasNoBorders() && !m_internalSettings->roundBottomCornersWhenNoBorders() && !c->isShaded()) {
-        roundedRectMask = GeometryTools::roundedPath(innerRect, CornersTop, m_scaledCornerRadius + 0.5);
+    if (shadowParams.squareBottomCorners) {
+        roundedRectMask = GeometryTools::roundedPath(innerRect, CornersTop, shadowParams.cornerRadius + 0.5);
     } else {
-        roundedRectMask.addRoundedRect(innerRect, m_scaledCornerRadius + 0.5, m_scaledCornerRadius + 0.5);
+        roundedRectMask.addRoundedRect(innerRect, shadowParams.cornerRadius + 0.5, shadowParams.cornerRadius + 0.5);
     }
 
     painter.drawPath(roundedRectMask);
+    painter.end();
 
-    // Draw Thin window outline
-    if (!windowOutlineNone || isThinWindowOutlineOverride) {
-        if (m_thinWindowOutline.isValid()) {
-            QPen p;
-            p.setColor(m_thinWindowOutline);
-            // use a miter join rather than the default bevel join to get sharp corners at low radii
-            if (m_internalSettings->windowCornerRadius() < 0.4)
-                p.setJoinStyle(Qt::MiterJoin);
-
-            qreal outlinePenWidth = m_internalSettings->thinWindowOutlineThickness();
-
-            // the overlap between the thin window outline and behind the window in unscaled pixels.
-            // This is necessary for the thin window outline to sit flush with the window on Wayland,
-            // and also makes sure that the anti-aliasing blends properly between the window and thin window outline
-            qreal outlineOverlap = 0.5;
-
-            // scale outline
-            // We can't get the DPR for Wayland from KDecoration/KWin but can work around this as Wayland will auto-scale if you don't use a cosmetic pen. On
-            // X11 this does not happen but we can use the system-set scaling value directly.
-            if (KWindowSystem::isPlatformX11()) {
-                outlinePenWidth *= m_systemScaleFactorX11;
-                outlineOverlap *= m_systemScaleFactorX11;
-            }
+    return shadowTexture;
+}
 
-            qreal outlineAdjustment = outlinePenWidth / 2 - outlineOverlap;
-            QRectF outlineRect;
-            outlineRect =
-                innerRect.adjusted(-outlineAdjustment,
-                                   -outlineAdjustment,
-                                   outlineAdjustment,
-                                   outlineAdjustment); // make thin window outline rect larger so most is outside the window, except for a 0.5px scaled overlap
-
-            p.setWidthF(outlinePenWidth);
-            painter.setPen(p);
-            painter.setBrush(Qt::NoBrush);
-            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-
-            QPainterPath outlinePath;
-            qreal cornerRadius;
-
-            if (m_internalSettings->windowCornerRadius() < 0.4)
-                cornerRadius = m_scaledCornerRadius; // give a square corner for when corner radius is 0
-            else
-                cornerRadius = m_scaledCornerRadius + outlineAdjustment; // else round corner slightly more to account for pen width
-
-            if (hasNoBorders() && !m_internalSettings->roundBottomCornersWhenNoBorders() && !c->isShaded()) {
-                outlinePath = GeometryTools::roundedPath(outlineRect, CornersTop, cornerRadius);
-            } else {
-                outlinePath.addRoundedRect(outlineRect, cornerRadius, cornerRadius);
-            }
+//________________________________________________________________
+std::shared_ptr<KDecoration2::DecorationShadow> Decoration::createShadowObject(const ShadowParameters &shadowParams, const bool analytic)
+{
+    if (shadowParams.isNone()) {
+        return nullptr;
+    }
+
+    const CompositeShadowParams params = lookupShadowParams(shadowParams.shadowSize);
+
+    // The blurred shadow body does not depend on the thin window outline, so it is cached separately and only the outline is drawn here.
+    // This keeps animating the outline colour, e.g. when colourizing it with a hovered button's colour, as cheap as stroking a path.
+    ShadowParameters bodyParams;
+    bodyParams.shadowSize = shadowParams.shadowSize;
+    bodyParams.shadowColor = shadowParams.shadowColor;
+    bodyParams.cornerRadius = shadowParams.cornerRadius;
+    bodyParams.squareBottomCorners = shadowParams.squareBottomCorners;
 
-            painter.drawPath(outlinePath);
+    // analytic bodies are only rendered for transient animation frames, so are not cached
+    QImage shadowTexture;
+    if (QImage *cachedBody = analytic ? nullptr : g_shadowBodyCache.object(bodyParams)) {
+        shadowTexture = *cachedBody;
+    } else {
+        shadowTexture = renderShadowBody(bodyParams, analytic);
+        if (!analytic) {
+            g_shadowBodyCache.insert(bodyParams, new QImage(shadowTexture));
         }
     }
-    painter.end();
+
+    const QRect outerRect = shadowTexture.rect();
+    const QMargins padding = shadowPadding(outerRect, params);
+    const QRectF innerRect = outerRect - padding;
+
+    // Draw Thin window outline
+    if (shadowParams.drawOutline) {
+        QPainter painter(&shadowTexture);
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        QPen p;
+        p.setColor(QColor::fromRgba(shadowParams.outlineColor));
+        // use a miter join rather than the default bevel join to get sharp corners at low radii
+        if (shadowParams.outlineMiterJoin)
+            p.setJoinStyle(Qt::MiterJoin);
+
+        const qreal outlinePenWidth = shadowParams.outlinePenWidth;
+        const qreal outlineAdjustment = outlinePenWidth / 2 - shadowParams.outlineOverlap;
+        // make thin window outline rect larger so most is outside the window, except for a 0.5px scaled overlap
+        const QRectF outlineRect = innerRect.adjusted(-outlineAdjustment, -outlineAdjustment, outlineAdjustment, outlineAdjustment);
+
+        p.setWidthF(outlinePenWidth);
+        painter.setPen(p);
+        painter.setBrush(Qt::NoBrush);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+        QPainterPath outlinePath;
+        qreal cornerRadius;
+
+        if (shadowParams.outlineMiterJoin)
+            cornerRadius = shadowParams.cornerRadius; // give a square corner for when corner radius is 0
+        else
+            cornerRadius = shadowParams.cornerRadius + outlineAdjustment; // else round corner slightly more to account for pen width
+
+        if (shadowParams.squareBottomCorners) {
+            outlinePath = GeometryTools::roundedPath(outlineRect, CornersTop, cornerRadius);
+        } else {
+            outlinePath.addRoundedRect(outlineRect, cornerRadius, cornerRadius);
+        }
+
+        painter.drawPath(outlinePath);
+        painter.end();
+    }
 
     auto ret = std::make_shared<KDecoration2::DecorationShadow>();
     ret->setPadding(padding);
@@ -1799,13 +2164,30 @@ void Decoration::updateBlur()
         setBlurRegion(QRegion());
     } else { // transparent titlebar colours
         if (m_internalSettings->blurTransparentTitleBars()) { // enable blur
-            calculateWindowAndTitleBarShapes(true); // refreshes m_windowPath
-            setBlurRegion(QRegion(m_windowPath.toFillPolygon().toPolygon()));
+            setBlurRegion(windowRegion());
         } else
             setBlurRegion(QRegion());
     }
 }
 
+//________________________________________________________________
+QRegion Decoration::windowRegion() const
+{
+    auto c = client();
+    auto s = settings();
+
+    // the same shape as m_windowPath, but assembled from rectangles rather than by rasterizing the path, which is costly on every frame of a resize
+    const bool rounded = s->isAlphaChannelSupported() && !isMaximized();
+    const Corners corners = rounded ? Corners(AllCorners) : Corners();
+    if (c->isShaded()) {
+        return GeometryTools::roundedRegion(QRect(QPoint(0, 0), QSize(size().width(), borderTop())), corners, m_scaledCornerRadius);
+    } else if (rounded && hasNoBorders() && !m_internalSettings->roundBottomCornersWhenNoBorders()) {
+        return GeometryTools::roundedRegion(rect(), CornersTop, m_scaledCornerRadius);
+    } else {
+        return GeometryTools::roundedRegion(rect(), corners, m_scaledCornerRadius);
+    }
+}
+
 bool Decoration::isOpaqueTitleBar()
 {
     QColor activeTitleBarColor = m_decorationColors->active()->titleBarBase;
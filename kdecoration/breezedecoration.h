@@ -19,8 +19,10 @@
 #include <KDecoration2/DecorationSettings>
 #include <KSharedConfig>
 
+#include <QImage>
 #include <QPainterPath>
 #include <QPalette>
+#include <QStaticText>
 #include <QVariant>
 #include <QVariantAnimation>
 
@@ -40,6 +42,77 @@ enum struct ButtonBackgroundType {
     FullHeight,
 };
 
+//* all the parameters that determine a rendered decoration shadow, used as the key of the shadow cache shared by all decorations
+struct ShadowParameters {
+    int shadowSize = InternalSettings::EnumShadowSize::ShadowLarge;
+    //* the window outline is not drawn and not animating
+    bool noOutline = true;
+    QRgb shadowColor = 0;
+    //* scaled window corner radius
+    qreal cornerRadius = 0;
+    //* only round the top corners (no borders without rounded bottom corners, and not shaded)
+    bool squareBottomCorners = false;
+    //* draw a thin window outline with a valid colour
+    bool drawOutline = false;
+    QRgb outlineColor = 0;
+    //* outline pen width, including any X11 scaling
+    qreal outlinePenWidth = 0;
+    //* outline overlap behind the window, including any X11 scaling
+    qreal outlineOverlap = 0;
+    //* use a miter join and square outline corners at low corner radii
+    bool outlineMiterJoin = false;
+
+    //* no shadow object is needed at all
+    bool isNone() const
+    {
+        return shadowSize == InternalSettings::EnumShadowSize::ShadowNone && noOutline;
+    }
+
+    bool operator==(const ShadowParameters &other) const = default;
+};
+
+size_t qHash(const ShadowParameters &key, size_t seed = 0);
+
+//* everything the window and titlebar paths depend on
+struct WindowShapeKey {
+    QSize size;
+    int borderTop = 0;
+    qreal cornerRadius = 0;
+    bool maximized = false;
+    bool shaded = false;
+    bool alphaChannelSupported = false;
+    //* only round the top corners of the window (no borders without rounded bottom corners)
+    bool squareBottomCorners = false;
+
+    bool operator==(const WindowShapeKey &other) const = default;
+};
+
+//* everything the prepared caption text depends on
+struct CaptionKey {
+    QString caption;
+    QFont font;
+    int width = 0;
+    Qt::Alignment alignment;
+
+    bool operator==(const CaptionKey &other) const = default;
+};
+
+//* everything a cached titlebar background image depends on
+struct TitleBarImageKey {
+    WindowShapeKey shape;
+    qreal devicePixelRatio = 1;
+    //* separator pen width, which also depends on the X11 scale factor
+    qreal separatorPenWidth = 0;
+    QRgb color = 0;
+    bool gradient = false;
+    QRgb separatorColor = 0;
+    int separatorHeight = 0;
+    int separatorLeftInset = 0;
+    int separatorRightInset = 0;
+
+    bool operator==(const TitleBarImageKey &other) const = default;
+};
+
 class Decoration : public KDecoration2::Decoration
 {
     Q_OBJECT
@@ -88,6 +161,8 @@ public:
 
     QColor titleBarColor(bool returnNonAnimatedColor = false) const;
     QColor titleBarSeparatorColor() const;
+    //* the non-animated titlebar colour of the active or inactive state
+    QColor titleBarStateColor(const bool active) const;
     QColor fontColor(bool returnNonAnimatedColor = false) const;
     QColor overriddenOutlineColorAnimateIn() const;
     QColor overriddenOutlineColorAnimateOut(const QColor &destinationColor);
@@ -191,23 +266,48 @@ private Q_SLOTS:
     void updateButtonsGeometryDelayed();
     void updateTitleBar();
     void updateAnimationState();
-    void updateShadowOnShadedChange()
-    {
-        updateShadow();
-    }
+    void flushUpdates();
     void onTabletModeChanged(bool mode);
 
 private:
+    //* state which is recomputed at most once per event loop turn, however many signals requested it
+    enum UpdateCategory {
+        UpdateTitleBar = 0x1,
+        UpdateButtonsGeometry = 0x2,
+        UpdateOpaque = 0x4,
+        UpdateBlur = 0x8,
+        UpdateShadow = 0x10,
+    };
+    static constexpr int UpdateCategoryCount = 5;
+
+    //* mark the given UpdateCategory flags dirty, and schedule flushUpdates() if not already scheduled
+    void scheduleUpdates(const int categories);
+
     //* return the rect in which caption will be drawn
     QPair<QRect, Qt::Alignment> captionRect() const;
 
     void reconfigureMain(const bool noUpdateShadow = false);
     void updateDecorationColors(const QPalette &clientPalette, QByteArray uuid = "");
     void createButtons();
-    void calculateWindowAndTitleBarShapes(const bool windowShapeOnly = false);
+    void calculateWindowAndTitleBarShapes();
+    //* the area of m_windowPath, for the blur region
+    QRegion windowRegion() const;
     void paintTitleBar(QPainter *painter, const QRect &repaintRegion);
+    //* returns the titlebar background and separator of the active or inactive state, rendering it if anything it depends on has changed
+    const QImage &titleBarImage(const bool active, QPainter *painter);
+    void paintTitleBarSeparator(QPainter *painter,
+                                const QColor &color,
+                                const int separatorHeight,
+                                const qreal penWidth,
+                                const int leftInset,
+                                const int rightInset) const;
     void updateShadow(const bool forceUpdateCache = false, bool noCache = false, const bool isThinWindowOutlineOverride = false);
-    std::shared_ptr<KDecoration2::DecorationShadow> createShadowObject(QColor shadowColor, const bool isThinWindowOutlineOverride = false);
+    ShadowParameters shadowParameters(const QColor &shadowColor, const QColor &outlineColor, const bool isThinWindowOutlineOverride = false) const;
+    std::shared_ptr<KDecoration2::DecorationShadow> createShadowObject(const ShadowParameters &shadowParams, const bool analytic = false);
+    //* returns the shared shadow for params, creating and caching it if needed
+    std::shared_ptr<KDecoration2::DecorationShadow> cachedShadowObject(const ShadowParameters &params);
+    //* returns the current frame of the active/inactive shadow animation, interpolated between the cached endpoint shadows, or nullptr if not possible
+    std::shared_ptr<KDecoration2::DecorationShadow> shadowAnimationFrame(const ShadowParameters &inactiveParams, const ShadowParameters &activeParams);
     void setScaledCornerRadius();
 
     //*@name border size
@@ -235,7 +335,13 @@ private:
 
     void setGlobalLookAndFeelOptions(QString lookAndFeelPackageName);
 
+    //* reparses s_kdeGlobalConfig, if not already done for the current settings generation
+    static void reparseKdeGlobalConfig();
+
     static KSharedConfig::Ptr s_kdeGlobalConfig;
+    //* settings provider generation at which s_kdeGlobalConfig was last reparsed
+    static quint64 s_kdeGlobalConfigGeneration;
+    static bool s_kdeGlobalConfigParsed;
     InternalSettingsPtr m_internalSettings;
     KDecoration2::DecorationButtonGroup *m_leftButtons = nullptr;
     KDecoration2::DecorationButtonGroup *m_rightButtons = nullptr;
@@ -243,6 +349,14 @@ private:
     //* Whether the paint() method is active
     bool m_painting = false;
 
+    //* UpdateCategory flags waiting for flushUpdates()
+    int m_pendingUpdates = 0;
+#if KLASSY_DECORATION_DEBUG_MODE
+    //* number of requested and performed updates per UpdateCategory, showing how many were coalesced
+    int m_requestedUpdateCounts[UpdateCategoryCount] = {};
+    int m_performedUpdateCounts[UpdateCategoryCount] = {};
+#endif
+
     //* Object to return decoration palette colours
     std::unique_ptr<DecorationColors> m_decorationColors;
 
@@ -283,6 +397,20 @@ private:
     QPainterPath m_titleBarPath = QPainterPath();
     //* Exact window path, with clipped rounded corners
     QPainterPath m_windowPath = QPainterPath();
+    //* m_windowPath without the titlebar area, i.e. the borders
+    QPainterPath m_windowPathMinusTitleBar = QPainterPath();
+    //* the inputs m_titleRect and the window and titlebar paths were last calculated from
+    WindowShapeKey m_windowShapeKey;
+    bool m_windowShapeValid = false;
+
+    //* titlebar backgrounds of the inactive [0] and active [1] states, crossfaded during the active state change animation
+    QImage m_titleBarImages[2];
+    TitleBarImageKey m_titleBarImageKeys[2];
+
+    //* elided caption, laid out once and reused until m_captionKey changes
+    QStaticText m_caption;
+    CaptionKey m_captionKey;
+    bool m_captionValid = false;
 
     qreal m_systemScaleFactorX11 = 1.0;
 
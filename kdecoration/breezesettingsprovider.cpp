@@ -7,9 +7,12 @@
 
 #include "breezesettingsprovider.h"
 #include "dbusmessages.h"
+#include "dbusupdatenotifier.h"
 #include "decorationexceptionlist.h"
 #include "presetsmodel.h"
 
+#include <QDBusConnection>
+#include <QDebug>
 #include <QRegularExpression>
 #include <QTextStream>
 
@@ -24,6 +27,19 @@ SettingsProvider::SettingsProvider()
     , m_presetsConfig(KSharedConfigPtr())
 {
     m_defaultSettings = InternalSettingsPtr(new InternalSettings());
+
+    // QtDBus does not call the slots connected to one D-Bus signal in a defined order, so the decorations do not connect to notifyChange
+    // themselves but to globalSettingsChanged, which is only emitted once the new generation has been started
+    QDBusConnection::sessionBus().connect(QString(),
+                                          QStringLiteral("/KGlobalSettings"),
+                                          QStringLiteral("org.kde.KGlobalSettings"),
+                                          QStringLiteral("notifyChange"),
+                                          this,
+                                          SLOT(onGlobalSettingsChanged()));
+
+    // these connections are made before any decoration makes its own, so a new generation is started before the decorations reconfigure
+    connect(&g_dBusUpdateNotifier, &DBusUpdateNotifier::decorationSettingsUpdate, this, &SettingsProvider::invalidate);
+    connect(&g_dBusUpdateNotifier, &DBusUpdateNotifier::systemColorSchemeUpdate, this, &SettingsProvider::invalidate);
 }
 
 //__________________________________________________________________
@@ -43,15 +59,74 @@ SettingsProvider *SettingsProvider::self()
     return s_self;
 }
 
+//__________________________________________________________________
+void SettingsProvider::watchDecorationSettings(const std::shared_ptr<KDecoration2::DecorationSettings> &settings)
+{
+    if (!settings) {
+        return;
+    }
+
+    m_watchedSettings.removeAll(QPointer<KDecoration2::DecorationSettings>());
+    if (m_watchedSettings.contains(settings.get())) {
+        return;
+    }
+
+    m_watchedSettings.append(settings.get());
+    connect(settings.get(), &KDecoration2::DecorationSettings::reconfigured, this, &SettingsProvider::invalidate);
+}
+
+//__________________________________________________________________
+void SettingsProvider::invalidate()
+{
+    // only advance once per loaded generation, so several notifications for the same change before a reload cost a single parse
+    if (m_requestedGeneration == m_loadedGeneration) {
+        m_requestedGeneration++;
+    }
+}
+
+//__________________________________________________________________
+void SettingsProvider::onGlobalSettingsChanged()
+{
+    invalidate();
+    Q_EMIT globalSettingsChanged();
+}
+
 //__________________________________________________________________
 void SettingsProvider::reconfigure()
 {
+    // the configuration is shared by all decorations, so only the first decoration to see a new generation reloads it
+    if (m_loaded && m_loadedGeneration == m_requestedGeneration) {
+        return;
+    }
+    m_loaded = true;
+    m_loadedGeneration = m_requestedGeneration;
+    m_loadCount++;
+
+#if KLASSY_DECORATION_DEBUG_MODE
+    qDebug() << "Klassy: SettingsProvider loading configuration generation" << m_loadedGeneration << ", load count" << m_loadCount;
+#endif
+
     m_defaultSettings->load();
 
     DecorationExceptionList exceptions;
     exceptions.readConfig(m_config);
     m_exceptions = exceptions.getDefault();
     m_exceptions.append(exceptions.get());
+
+    // compile the patterns once here rather than for every decoration lookup
+    m_exceptionPatterns.clear();
+    m_exceptionPatterns.reserve(m_exceptions.size());
+    for (const auto &internalSettings : std::as_const(m_exceptions)) {
+        QRegularExpression rx;
+        // discard disabled exceptions and exceptions with empty exception pattern
+        if (internalSettings->enabled() && !internalSettings->exceptionWindowPropertyPattern().isEmpty()) {
+            rx.setPattern(internalSettings->exceptionWindowPropertyPattern());
+            rx.optimize();
+        }
+        m_exceptionPatterns.append(rx);
+    }
+
+    m_exceptionMatches.clear();
 }
 
 //__________________________________________________________________
@@ -60,14 +135,24 @@ InternalSettingsPtr SettingsProvider::internalSettings(Decoration *decoration)
     // get the client
     auto client = decoration->client();
 
-    for (auto internalSettings : std::as_const(m_exceptions)) {
-        // discard disabled exceptions
-        if (!internalSettings->enabled()) {
-            continue;
-        }
+    const QPair<QString, QString> matchKey(client->windowClass(), client->caption());
+    auto matchIt = m_exceptionMatches.constFind(matchKey);
+    if (matchIt != m_exceptionMatches.constEnd()) {
+        // any preset was already loaded into the exception when it was first matched
+        return matchIt.value() < 0 ? m_defaultSettings : m_exceptions.at(matchIt.value());
+    }
 
-        // discard exceptions with empty exception pattern
-        if (internalSettings->exceptionWindowPropertyPattern().isEmpty()) {
+    // window captions can change continuously, so do not let the memo grow without bound
+    if (m_exceptionMatches.size() >= MaxExceptionMatches) {
+        m_exceptionMatches.clear();
+    }
+
+    for (int index = 0; index < m_exceptions.size(); ++index) {
+        auto internalSettings = m_exceptions.at(index);
+        const QRegularExpression &rx = m_exceptionPatterns.at(index);
+
+        // discard disabled exceptions and exceptions with empty exception pattern
+        if (rx.pattern().isEmpty()) {
             continue;
         }
 
@@ -90,8 +175,9 @@ InternalSettingsPtr SettingsProvider::internalSettings(Decoration *decoration)
         }
 
         // check matching
-        QRegularExpression rx(internalSettings->exceptionWindowPropertyPattern());
         if (rx.match(windowPropertyValue).hasMatch()) {
+            m_exceptionMatches.insert(matchKey, index);
+
             // load preset if set
             if (!internalSettings->exceptionPreset().isEmpty()) {
                 if (!m_presetsConfig) {
@@ -125,6 +211,7 @@ InternalSettingsPtr SettingsProvider::internalSettings(Decoration *decoration)
         }
     }
 
+    m_exceptionMatches.insert(matchKey, -1);
     return m_defaultSettings;
 }
 
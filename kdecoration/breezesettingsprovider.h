@@ -10,9 +10,16 @@
 #include "breezedecoration.h"
 #include "breezesettings.h"
 
+#include <KDecoration2/DecorationSettings>
 #include <KSharedConfig>
 
+#include <QHash>
+#include <QList>
 #include <QObject>
+#include <QPointer>
+#include <QRegularExpression>
+
+#include <memory>
 
 namespace Breeze
 {
@@ -31,11 +38,40 @@ public:
     //* internal settings for given decoration
     InternalSettingsPtr internalSettings(Decoration *);
 
+    //* configuration generation that is currently loaded
+    quint64 generation() const
+    {
+        return m_loadedGeneration;
+    }
+
+    //* number of times the configuration has actually been (re-)loaded from disk, to verify that one settings change costs one parse
+    quint64 loadCount() const
+    {
+        return m_loadCount;
+    }
+
+    /**
+     * @brief Starts a new configuration generation whenever the given settings object emits reconfigured.
+     *        Must be called before a decoration connects its own slots to the reconfigured signal, so that the generation is already advanced when they run.
+     */
+    void watchDecorationSettings(const std::shared_ptr<KDecoration2::DecorationSettings> &settings);
+
 public Q_SLOTS:
 
-    //* reconfigure
+    //* reconfigure, only reloading from disk if a new configuration generation has started since the last load
     void reconfigure();
 
+    //* start a new configuration generation, so the next call to reconfigure() reloads
+    void invalidate();
+
+Q_SIGNALS:
+    //* emitted on KGlobalSettings notifyChange, after a new configuration generation has been started
+    void globalSettingsChanged();
+
+private Q_SLOTS:
+    //* starts a new configuration generation and notifies the decorations
+    void onGlobalSettingsChanged();
+
 private:
     //* constructor
     SettingsProvider();
@@ -46,6 +82,30 @@ private:
     //* exceptions
     InternalSettingsList m_exceptions;
 
+    //* compiled exception window property patterns, with the same indexes as m_exceptions
+    QList<QRegularExpression> m_exceptionPatterns;
+
+    //* memo of matched exception index (-1 for the default settings), keyed by window class and caption
+    QHash<QPair<QString, QString>, int> m_exceptionMatches;
+
+    //* maximum number of entries in m_exceptionMatches before it is flushed
+    static constexpr int MaxExceptionMatches = 512;
+
+    //* latest configuration generation requested by a change notification
+    quint64 m_requestedGeneration = 0;
+
+    //* configuration generation currently loaded
+    quint64 m_loadedGeneration = 0;
+
+    //* whether the configuration has been loaded at all yet
+    bool m_loaded = false;
+
+    //* number of configuration loads
+    quint64 m_loadCount = 0;
+
+    //* settings objects whose reconfigured signal is already watched
+    QList<QPointer<KDecoration2::DecorationSettings>> m_watchedSettings;
+
     //* config object
     KSharedConfigPtr m_config;
 
@@ -8,29 +8,166 @@
 
 #include "breeze.h"
 
-#include <QMap>
 #include <QObject>
 #include <QPaintDevice>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace Breeze
 {
 
 //* data map
-/** it maps an opaque pointer an associated QPointer<object> */
+/**
+ * it maps an opaque pointer an associated QPointer<object>.
+ * Entries live in one flat array, addressed by linear probing;
+ * removal shifts the following entries of the probe sequence back instead of leaving tombstones
+ */
 template<typename T>
-class DataMap : public QMap<const void *, WeakPointer<T>>
+class DataMap
 {
 public:
     using Key = const void *;
     using Value = WeakPointer<T>;
 
+private:
+    //* one table slot, empty if key is null
+    struct Slot {
+        Key key = nullptr;
+        Value value;
+    };
+
+    using Slots = std::vector<Slot>;
+
+public:
+    //* iterator over the occupied slots
+    template<typename SlotIterator, typename ValueReference>
+    class Iterator
+    {
+    public:
+        Iterator(SlotIterator iter, SlotIterator end)
+            : _iter(iter)
+            , _end(end)
+        {
+            skipEmpty();
+        }
+
+        Key key() const
+        {
+            return _iter->key;
+        }
+
+        ValueReference value() const
+        {
+            return _iter->value;
+        }
+
+        ValueReference operator*() const
+        {
+            return _iter->value;
+        }
+
+        Iterator &operator++()
+        {
+            ++_iter;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const
+        {
+            return _iter == other._iter;
+        }
+
+        bool operator!=(const Iterator &other) const
+        {
+            return _iter != other._iter;
+        }
+
+    private:
+        void skipEmpty()
+        {
+            while (_iter != _end && !_iter->key) {
+                ++_iter;
+            }
+        }
+
+        SlotIterator _iter;
+        SlotIterator _end;
+    };
+
+    using iterator = Iterator<typename Slots::iterator, Value &>;
+    using const_iterator = Iterator<typename Slots::const_iterator, const Value &>;
+
+    iterator begin()
+    {
+        return iterator(_slots.begin(), _slots.end());
+    }
+
+    iterator end()
+    {
+        return iterator(_slots.end(), _slots.end());
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(_slots.begin(), _slots.end());
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(_slots.end(), _slots.end());
+    }
+
+    //* number of entries
+    int size() const
+    {
+        return int(_size);
+    }
+
+    //* true if empty
+    bool isEmpty() const
+    {
+        return _size == 0;
+    }
+
+    //* true if key is registered
+    bool contains(Key key) const
+    {
+        return key && !_slots.empty() && _slots[slotIndex(key)].key;
+    }
+
     //* insertion
-    typename QMap<Key, Value>::iterator insert(const Key &key, const Value &value, bool enabled = true)
+    iterator insert(const Key &key, const Value &value, bool enabled = true)
     {
+        if (!key) {
+            return end();
+        }
+
         if (value) {
             value.data()->setEnabled(enabled);
         }
-        return QMap<Key, Value>::insert(key, value);
+
+        // look the key up first, so that replacing the value of a registered key never rehashes
+        size_t index(_slots.empty() ? 0 : slotIndex(key));
+        if (_slots.empty() || !_slots[index].key) {
+            // keep the load factor at or below one half, so that probe sequences stay short
+            if (2 * (_size + 1) > _slots.size()) {
+                rehash(std::max(MinimumCapacity, 2 * _slots.size()));
+                index = slotIndex(key);
+            }
+
+            _slots[index].key = key;
+            ++_size;
+        }
+        _slots[index].value = value;
+
+        if (key == _lastKey) {
+            _lastValue = value;
+        }
+
+        return iterator(_slots.begin() + index, _slots.end());
     }
 
     //* find value
@@ -43,9 +180,11 @@ public:
             return _lastValue;
         } else {
             Value out;
-            typename QMap<Key, Value>::iterator iter(QMap<Key, Value>::find(key));
-            if (iter != QMap<Key, Value>::end()) {
-                out = iter.value();
+            if (!_slots.empty()) {
+                const Slot &slot(_slots[slotIndex(key)]);
+                if (slot.key) {
+                    out = slot.value;
+                }
             }
             _lastKey = key;
             _lastValue = out;
@@ -70,16 +209,31 @@ public:
         }
 
         // find key in map
-        typename QMap<Key, Value>::iterator iter(QMap<Key, Value>::find(key));
-        if (iter == QMap<Key, Value>::end()) {
+        if (_slots.empty()) {
+            return false;
+        }
+        size_t hole(slotIndex(key));
+        if (!_slots[hole].key) {
             return false;
         }
 
         // delete value from map if found
-        if (iter.value()) {
-            iter.value().data()->deleteLater();
+        if (_slots[hole].value) {
+            _slots[hole].value.data()->deleteLater();
         }
-        QMap<Key, Value>::erase(iter);
+
+        // shift back every following entry of the probe sequence that may move into the hole
+        const size_t mask(_slots.size() - 1);
+        for (size_t next = (hole + 1) & mask; _slots[next].key; next = (next + 1) & mask) {
+            const size_t home(homeIndex(_slots[next].key));
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                _slots[hole] = std::move(_slots[next]);
+                hole = next;
+            }
+        }
+
+        _slots[hole] = Slot();
+        --_size;
 
         return true;
     }
@@ -112,6 +266,47 @@ public:
     }
 
 private:
+    //* initial number of slots, a power of two
+    static constexpr size_t MinimumCapacity = 16;
+
+    //* preferred slot of key
+    size_t homeIndex(Key key) const
+    {
+        // widget pointers are aligned, so multiply to spread their high bits over the low ones used as index
+        const quint64 hash(quint64(quintptr(key)) * Q_UINT64_C(0x9E3779B97F4A7C15));
+        return size_t(hash >> 32) & (_slots.size() - 1);
+    }
+
+    //* slot holding key, or the empty slot where it would be inserted; the table must not be empty
+    size_t slotIndex(Key key) const
+    {
+        const size_t mask(_slots.size() - 1);
+        size_t index(homeIndex(key));
+        while (_slots[index].key && _slots[index].key != key) {
+            index = (index + 1) & mask;
+        }
+
+        return index;
+    }
+
+    //* move all entries to a table of capacity slots
+    void rehash(size_t capacity)
+    {
+        Slots slots(capacity);
+        std::swap(slots, _slots);
+        for (Slot &slot : slots) {
+            if (slot.key) {
+                _slots[slotIndex(slot.key)] = std::move(slot);
+            }
+        }
+    }
+
+    //* slots, empty or with a power of two size
+    Slots _slots;
+
+    //* number of occupied slots
+    size_t _size = 0;
+
     //* enability
     bool _enabled = true;
 
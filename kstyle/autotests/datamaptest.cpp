@@ -0,0 +1,240 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Paul A McAuley <kde@paulmcauley.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "breezedatamap.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using namespace Breeze;
+
+//* stand-in for the animation data classes stored in DataMap
+class TestData : public QObject
+{
+public:
+    using QObject::QObject;
+
+    void setEnabled(bool value)
+    {
+        enabled = value;
+    }
+
+    void setDuration(int value)
+    {
+        duration = value;
+    }
+
+    bool enabled = true;
+    int duration = 0;
+};
+
+class DataMapTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void randomOperations();
+    void benchmarkFind_data();
+    void benchmarkFind();
+    void benchmarkInsert_data();
+    void benchmarkInsert();
+    void benchmarkUnregisterWidget_data();
+    void benchmarkUnregisterWidget();
+};
+
+//* checks every entry of map against reference, both ways
+static void compareMaps(const DataMap<TestData> &map, const std::map<const void *, QPointer<TestData>> &reference)
+{
+    QCOMPARE(map.size(), int(reference.size()));
+    QCOMPARE(map.isEmpty(), reference.empty());
+
+    int count(0);
+    for (auto iter = map.begin(); iter != map.end(); ++iter) {
+        const auto referenceIter(reference.find(iter.key()));
+        QVERIFY(referenceIter != reference.end());
+        QCOMPARE(iter.value().data(), referenceIter->second.data());
+        ++count;
+    }
+    QCOMPARE(count, int(reference.size()));
+
+    for (const auto &entry : reference) {
+        QVERIFY(map.contains(entry.first));
+    }
+}
+
+void DataMapTest::randomOperations()
+{
+    // keys are drawn from a small pool, so that inserts hit registered keys and removals shift whole probe sequences
+    std::vector<qint64> storage(300);
+    QObject parent;
+    DataMap<TestData> map;
+    std::map<const void *, QPointer<TestData>> reference;
+
+    QRandomGenerator generator(1);
+    for (int step = 0; step < 100000; ++step) {
+        const void *key(&storage[generator.bounded(int(storage.size()))]);
+        const int operation(generator.bounded(100));
+
+        if (operation < 40) {
+            const bool enabled(generator.bounded(2));
+            QPointer<TestData> value(generator.bounded(10) ? new TestData(&parent) : nullptr);
+            map.insert(key, value, enabled);
+            reference[key] = value;
+            if (value) {
+                QCOMPARE(value->enabled, enabled);
+            }
+
+        } else if (operation < 70) {
+            const auto referenceIter(reference.find(key));
+            const bool registered(referenceIter != reference.end());
+            QCOMPARE(map.unregisterWidget(key), registered);
+            if (registered) {
+                reference.erase(referenceIter);
+            }
+
+        } else if (operation < 98) {
+            // find twice, to go through the last key cache as well
+            const auto referenceIter(reference.find(key));
+            TestData *expected((map.enabled() && referenceIter != reference.end()) ? referenceIter->second.data() : nullptr);
+            QCOMPARE(map.find(key).data(), expected);
+            QCOMPARE(map.find(key).data(), expected);
+            QCOMPARE(map.contains(key), referenceIter != reference.end());
+
+        } else {
+            const bool enabled(generator.bounded(2));
+            map.setEnabled(enabled);
+            QCOMPARE(map.enabled(), enabled);
+            for (const auto &entry : reference) {
+                if (entry.second) {
+                    QCOMPARE(entry.second->enabled, enabled);
+                }
+            }
+        }
+
+        if (step % 1000 == 0) {
+            compareMaps(map, reference);
+            if (QTest::currentTestFailed()) {
+                return;
+            }
+        }
+    }
+
+    compareMaps(map, reference);
+
+    map.setDuration(250);
+    for (const auto &entry : reference) {
+        if (entry.second) {
+            QCOMPARE(entry.second->duration, 250);
+        }
+    }
+
+    // null keys are never registered
+    QVERIFY(map.insert(nullptr, new TestData(&parent)) == map.end());
+    QVERIFY(!map.contains(nullptr));
+    QVERIFY(!map.unregisterWidget(nullptr));
+}
+
+//* keys for count entries, pointing into storage
+static std::vector<const void *> makeKeys(std::vector<qint64> &storage, int count)
+{
+    storage.assign(count, 0);
+    std::vector<const void *> keys;
+    keys.reserve(count);
+    for (qint64 &value : storage) {
+        keys.push_back(&value);
+    }
+
+    // visit the keys out of order, as widgets do not register in address order
+    QRandomGenerator generator(count);
+    std::shuffle(keys.begin(), keys.end(), generator);
+    return keys;
+}
+
+static void addSizeRows()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10") << 10;
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("100k") << 100000;
+}
+
+void DataMapTest::benchmarkFind_data()
+{
+    addSizeRows();
+}
+
+void DataMapTest::benchmarkFind()
+{
+    QFETCH(int, count);
+
+    std::vector<qint64> storage;
+    const std::vector<const void *> keys(makeKeys(storage, count));
+    DataMap<TestData> map;
+    for (const void *key : keys) {
+        map.insert(key, nullptr);
+    }
+
+    // consecutive keys differ, so every find() probes the table rather than the last key cache
+    QBENCHMARK {
+        for (const void *key : keys) {
+            map.find(key);
+        }
+    }
+}
+
+void DataMapTest::benchmarkInsert_data()
+{
+    addSizeRows();
+}
+
+void DataMapTest::benchmarkInsert()
+{
+    QFETCH(int, count);
+
+    std::vector<qint64> storage;
+    const std::vector<const void *> keys(makeKeys(storage, count));
+
+    QBENCHMARK {
+        DataMap<TestData> map;
+        for (const void *key : keys) {
+            map.insert(key, nullptr);
+        }
+    }
+}
+
+void DataMapTest::benchmarkUnregisterWidget_data()
+{
+    addSizeRows();
+}
+
+void DataMapTest::benchmarkUnregisterWidget()
+{
+    QFETCH(int, count);
+
+    std::vector<qint64> storage;
+    const std::vector<const void *> keys(makeKeys(storage, count));
+    DataMap<TestData> filledMap;
+    for (const void *key : keys) {
+        filledMap.insert(key, nullptr);
+    }
+
+    // each iteration also copies the filled map, so that there is something left to remove
+    QBENCHMARK {
+        DataMap<TestData> map(filledMap);
+        for (const void *key : keys) {
+            map.unregisterWidget(key);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(DataMapTest)
+
+#include "datamaptest.moc"
@@ -319,7 +319,7 @@ void FrameShadow::paintEvent(QPaintEvent *event)
 
     const QColor outline(_helper->frameOutlineColor(palette(), _mouseOver, _hasFocus, _opacity, _mode));
     painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-    _helper->renderFrame(&painter, rect, QColor(), outline);
+    _helper->renderFrame(&painter, rect, QColor(), outline, _mode != AnimationNone);
 }
 
 //____________________________________________________________________________________
@@ -26,6 +26,7 @@
 #endif
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 
 #include <QApplication>
@@ -38,6 +39,7 @@
 #include <QPainter>
 #include <QStyleOption>
 #include <QWindow>
+#include <QtMath>
 
 namespace Breeze
 {
@@ -86,6 +88,7 @@ void Helper::loadConfig()
     _config->reparseConfiguration();
     _kwinConfig->reparseConfiguration();
     _cachedAutoValid = false;
+    _frameTileCache.clear();
     DecorationSettingsProvider::self()->reconfigure();
     _decorationConfig = DecorationSettingsProvider::self()->internalSettings();
 
@@ -505,7 +508,7 @@ void Helper::renderFrameWithSides(QPainter *painter, const QRectF &rect, const Q
 }
 
 //______________________________________________________________________________
-void Helper::renderFrame(QPainter *painter, const QRectF &rect, const QColor &color, const QColor &outline) const
+void Helper::renderFrame(QPainter *painter, const QRectF &rect, const QColor &color, const QColor &outline, bool animated) const
 {
     painter->setRenderHint(QPainter::Antialiasing);
 
@@ -530,7 +533,9 @@ void Helper::renderFrame(QPainter *painter, const QRectF &rect, const QColor &co
     }
 
     // render
-    painter->drawRoundedRect(frameRect, radius, radius);
+    if (animated || !renderCachedFrame(painter, rect, frameRect, radius, AllCorners, color, outline, painter->pen().widthF())) {
+        painter->drawRoundedRect(frameRect, radius, radius);
+    }
 }
 
 //______________________________________________________________________________
@@ -616,7 +621,10 @@ void Helper::renderMenuFrame(QPainter *painter, const QRectF &rect, const QColor
         }
 
         // render
-        painter->drawRoundedRect(frameRect, radius, radius);
+        if (seamlessEdges != Qt::Edges()
+            || !renderCachedFrame(painter, rect, frameRect, radius, AllCorners, color, outline, painter->pen().widthF())) {
+            painter->drawRoundedRect(frameRect, radius, radius);
+        }
 
     } else {
         painter->setRenderHint(QPainter::Antialiasing, false);
@@ -744,6 +752,7 @@ void Helper::renderButtonFrame(QPainter *painter,
     }
 
     // Animations
+    const bool animated((bgAnimation != AnimationData::OpacityInvalid || penAnimation != AnimationData::OpacityInvalid) && enabled);
     if (bgAnimation != AnimationData::OpacityInvalid && enabled) {
         QColor color1 = bgBrush.color();
         QColor color2 = flat ? alphaColor(highlightColor, highlightBackgroundAlpha) : KColorUtils::mix(palette.button().color(), highlightColor, 0.333);
@@ -777,7 +786,15 @@ void Helper::renderButtonFrame(QPainter *painter,
     painter->setRenderHint(QPainter::Antialiasing, true);
     painter->setBrush(bgBrush);
     painter->setPen(QPen(penBrush, PenWidth::Frame));
-    painter->drawRoundedRect(frameRect, radius, radius);
+
+    // gradients cannot be stretched from tiles, and animated colours would only fill the cache with tiles used once
+    const bool solidBrushes = (bgBrush.style() == Qt::SolidPattern || bgBrush.style() == Qt::NoBrush)
+        && (penBrush.style() == Qt::SolidPattern || penBrush.style() == Qt::NoBrush);
+    const QColor color = bgBrush.style() == Qt::SolidPattern ? bgBrush.color() : QColor();
+    const QColor outline = penBrush.style() == Qt::SolidPattern ? penBrush.color() : QColor();
+    if (animated || !solidBrushes || !renderCachedFrame(painter, shadowedRect, frameRect, radius, AllCorners, color, outline, PenWidth::Frame)) {
+        painter->drawRoundedRect(frameRect, radius, radius);
+    }
 }
 
 //______________________________________________________________________________
@@ -847,8 +864,103 @@ void Helper::renderTabWidgetFrame(QPainter *painter, const QRectF &rect, const Q
     }
 
     // render
-    QPainterPath path(roundedPath(frameRect, corners, radius));
-    painter->drawPath(path);
+    if (!renderCachedFrame(painter, rect, frameRect, radius, corners, color, outline, painter->pen().widthF())) {
+        QPainterPath path(roundedPath(frameRect, corners, radius));
+        painter->drawPath(path);
+    }
+}
+
+//______________________________________________________________________________
+size_t qHash(const FrameTileKey &key, size_t seed)
+{
+    const int flags = (key.hasColor ? 0x1 : 0) | (key.hasOutline ? 0x2 : 0);
+    seed = hashCombine(seed, qHash(key.color));
+    seed = hashCombine(seed, qHash(key.outline));
+    seed = hashCombine(seed, qHash(flags));
+    seed = hashCombine(seed, qHash(key.radius));
+    seed = hashCombine(seed, qHash(key.margin));
+    seed = hashCombine(seed, qHash(key.penWidth));
+    seed = hashCombine(seed, qHash(key.devicePixelRatio));
+    return hashCombine(seed, qHash(key.corners));
+}
+
+//______________________________________________________________________________
+bool Helper::renderCachedFrame(QPainter *painter,
+                               const QRectF &rect,
+                               const QRectF &frameRect,
+                               qreal radius,
+                               Corners corners,
+                               const QColor &color,
+                               const QColor &outline,
+                               qreal penWidth) const
+{
+    if (!painter->device()) {
+        return false;
+    }
+
+    // tiles are only pixel-exact when they land on whole device pixels
+    const QTransform &transform(painter->worldTransform());
+    const qreal devicePixelRatio(painter->device()->devicePixelRatioF());
+    if (transform.type() > QTransform::TxTranslate || transform.dx() != std::round(transform.dx()) || transform.dy() != std::round(transform.dy())
+        || devicePixelRatio != std::round(devicePixelRatio) || QRectF(rect.toRect()) != rect) {
+        return false;
+    }
+
+    // the frame shape must be inset equally from each side so a single key describes it
+    const qreal margin(frameRect.left() - rect.left());
+    if (!qFuzzyCompare(frameRect.top() - rect.top() + 1, margin + 1) || !qFuzzyCompare(rect.right() - frameRect.right() + 1, margin + 1)
+        || !qFuzzyCompare(rect.bottom() - frameRect.bottom() + 1, margin + 1)) {
+        return false;
+    }
+
+    // an invisible pen must not affect the tile geometry
+    if (!outline.isValid()) {
+        penWidth = 0;
+    }
+
+    // corner tiles hold the whole rounded corner; the one pixel wide edge and centre tiles are stretched
+    const int cornerSize(qCeil(margin + radius + penWidth) + 1);
+    const int tileSize(2 * cornerSize + 1);
+    if (rect.width() < tileSize || rect.height() < tileSize) {
+        return false;
+    }
+
+    FrameTileKey key;
+    key.hasColor = color.isValid();
+    key.hasOutline = outline.isValid();
+    key.color = key.hasColor ? color.rgba() : 0;
+    key.outline = key.hasOutline ? outline.rgba() : 0;
+    key.radius = qRound(radius * 64);
+    key.margin = qRound(margin * 64);
+    key.penWidth = qRound(penWidth * 64);
+    key.devicePixelRatio = qRound(devicePixelRatio * 1000);
+    key.corners = int(corners);
+
+    TileSet *tileSet = _frameTileCache.object(key);
+    if (!tileSet) {
+        QPixmap pixmap(QSize(tileSize, tileSize) * devicePixelRatio);
+        pixmap.setDevicePixelRatio(devicePixelRatio);
+        pixmap.fill(Qt::transparent);
+
+        QPainter tilePainter(&pixmap);
+        tilePainter.setRenderHint(QPainter::Antialiasing);
+        tilePainter.setPen(key.hasOutline ? QPen(outline, penWidth) : QPen(Qt::NoPen));
+        tilePainter.setBrush(key.hasColor ? QBrush(color) : QBrush(Qt::NoBrush));
+
+        const QRectF tileFrameRect(QRectF(0, 0, tileSize, tileSize).adjusted(margin, margin, -margin, -margin));
+        if (corners == AllCorners) {
+            tilePainter.drawRoundedRect(tileFrameRect, radius, radius);
+        } else {
+            tilePainter.drawPath(roundedPath(tileFrameRect, corners, radius));
+        }
+        tilePainter.end();
+
+        tileSet = new TileSet(pixmap, cornerSize, cornerSize, 1, 1);
+        _frameTileCache.insert(key, tileSet);
+    }
+
+    tileSet->render(rect.toRect(), painter, key.hasColor ? TileSet::Full : TileSet::Ring);
+    return true;
 }
 
 //______________________________________________________________________________
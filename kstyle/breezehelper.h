@@ -10,6 +10,7 @@
 #include "breezeanimationdata.h"
 #include "breezemetrics.h"
 #include "breezesettings.h"
+#include "breezetileset.h"
 #include "colortools.h"
 #include "config-breeze.h"
 #include "decorationcolors.h"
@@ -18,6 +19,7 @@
 #include <KSharedConfig>
 #include <KStatefulBrush>
 
+#include <QCache>
 #include <QIcon>
 #include <QPainterPath>
 #include <QScrollBar>
@@ -31,6 +33,25 @@ class QStyleOptionSlider;
 namespace Breeze
 {
 
+//* identifies one cached 9-slice frame; lengths are in 1/64ths of a pixel
+struct FrameTileKey {
+    QRgb color = 0;
+    QRgb outline = 0;
+    bool hasColor = false;
+    bool hasOutline = false;
+    int radius = 0;
+    //* inset of the frame shape from the widget rect on each side
+    int margin = 0;
+    int penWidth = 0;
+    //* device pixel ratio, in 1/1000ths
+    int devicePixelRatio = 0;
+    int corners = 0;
+
+    bool operator==(const FrameTileKey &other) const = default;
+};
+
+size_t qHash(const FrameTileKey &key, size_t seed = 0);
+
 //* breeze style helper class.
 /** contains utility functions used at multiple places in both breeze style and breeze window decoration */
 class Helper : public QObject
@@ -199,8 +220,8 @@ public:
     //* focus line
     void renderFocusLine(QPainter *, const QRectF &, const QColor &) const;
 
-    //* generic frame
-    void renderFrame(QPainter *, const QRectF &, const QColor &color, const QColor &outline = QColor()) const;
+    //* generic frame; animated colours change every frame, so they bypass the frame tile cache
+    void renderFrame(QPainter *, const QRectF &, const QColor &color, const QColor &outline = QColor(), bool animated = false) const;
 
     //* generic frame, with separators only on the side
     void renderFrameWithSides(QPainter *, const QRectF &, const QColor &color, Qt::Edges edges, const QColor &outline = QColor()) const;
@@ -400,6 +421,23 @@ protected:
     //* return rounded path in a given rect, with only selected corners rounded, and for a given radius
     QPainterPath roundedPath(const QRectF &, Corners, qreal) const;
 
+    /**
+     * @brief Renders a rounded frame, filled with color and stroked with outline, from a cached 9-slice TileSet so that resized widgets reuse the same tiles.
+     *        Only possible for pixel-aligned rects on an integer device pixel ratio with an untransformed painter.
+     * @param rect The widget rect the frame is rendered in
+     * @param frameRect The rounded rect to fill and stroke, inset equally on all sides of rect
+     *        Callers skip it while color or outline is being animated, as each animation step would add tiles that are never reused.
+     * @return false, having drawn nothing, if the frame cannot be rendered from tiles
+     */
+    bool renderCachedFrame(QPainter *painter,
+                           const QRectF &rect,
+                           const QRectF &frameRect,
+                           qreal radius,
+                           Corners corners,
+                           const QColor &color,
+                           const QColor &outline,
+                           qreal penWidth) const;
+
 private:
     //* configuration
     KSharedConfig::Ptr _config;
@@ -432,6 +470,12 @@ private:
 
     mutable bool _cachedAutoValid = false;
 
+    //* maximum number of cached frame tile sets
+    static constexpr int FrameTileCacheSize = 256;
+
+    //* 9-slice frame tiles, see renderCachedFrame
+    mutable QCache<FrameTileKey, TileSet> _frameTileCache{FrameTileCacheSize};
+
     friend class ToolsAreaManager;
 };
 
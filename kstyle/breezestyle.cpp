@@ -18,6 +18,7 @@
 #include "breezeshadowhelper.h"
 #include "breezesplitterproxy.h"
 #include "breezestyleconfigdata.h"
+#include "breezetitlebarbuttoniconengine.h"
 #include "breezetoolsareamanager.h"
 #include "breezewidgetexplorer.h"
 #include "breezewindowmanager.h"
@@ -317,6 +318,16 @@ Style::Style()
     connect(qApp, &QApplication::paletteChanged, this, &Style::loadConfiguration);
 #endif
 
+    // memoized icon size metrics follow the icon loader and tablet mode
+    connect(KIconLoader::global(), &KIconLoader::iconLoaderSettingsChanged, this, [this]() {
+        _pixelMetricCache.clear();
+    });
+#if BREEZE_HAVE_QTQUICK
+    connect(TabletModeWatcher::self(), &TabletModeWatcher::tabletModeChanged, this, [this]() {
+        _pixelMetricCache.clear();
+    });
+#endif
+
     // call the slot directly; this initial call will set up things that also
     // need to be reset when the system palette changes
     loadConfiguration();
@@ -663,6 +674,55 @@ QLayout *findParentLayout(const QWidget *widget)
 
 //______________________________________________________________
 int Style::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWidget *widget) const
+{
+    // icon sizes are queried for every item of an item view, but only change with the configuration
+    if (!isOptionIndependentMetric(metric, option)) {
+        return pixelMetricImplementation(metric, option, widget);
+    }
+
+    const auto iter = _pixelMetricCache.constFind(metric);
+    if (iter != _pixelMetricCache.constEnd()) {
+        return iter.value();
+    }
+
+    const int value(pixelMetricImplementation(metric, option, widget));
+    _pixelMetricCache.insert(metric, value);
+    return value;
+}
+
+//______________________________________________________________
+bool Style::isOptionIndependentMetric(PixelMetric metric, const QStyleOption *option)
+{
+#if !BREEZE_HAVE_KSTYLE && QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    // QCommonStyle scales its icon sizes with the dpi of the option
+    if (option) {
+        return false;
+    }
+#else
+    Q_UNUSED(option);
+#endif
+
+    switch (metric) {
+    case PM_SmallIconSize:
+    case PM_ToolBarExtensionExtent:
+    case PM_TabCloseIndicatorWidth:
+    case PM_TabCloseIndicatorHeight:
+    case PM_TitleBarHeight:
+#if BREEZE_HAVE_KSTYLE
+    // KStyle reads these from KIconLoader
+    case PM_ButtonIconSize:
+    case PM_ToolBarIconSize:
+    case PM_LargeIconSize:
+#endif
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+//______________________________________________________________
+int Style::pixelMetricImplementation(PixelMetric metric, const QStyleOption *option, const QWidget *widget) const
 {
     // handle special cases
     switch (metric) {
@@ -2353,6 +2413,9 @@ void Style::loadConfiguration()
     // clear icon cache
     _iconCache.clear();
 
+    // clear memoized pixel metrics
+    _pixelMetricCache.clear();
+
     // scrollbar buttons
     switch (StyleConfigData::scrollBarAddLineButtons()) {
     case 0:
@@ -4210,7 +4273,7 @@ bool Style::drawFramePrimitive(const QStyleOption *option, QPainter *painter, co
 
         const auto background(palette.base().color());
         const auto outline(_helper->frameOutlineColor(palette, mouseOver, hasFocus, opacity, mode));
-        _helper->renderFrame(painter, rect, background, outline);
+        _helper->renderFrame(painter, rect, background, outline, mode != AnimationNone);
     }
 
     return true;
@@ -4320,7 +4383,7 @@ bool Style::drawFrameLineEditPrimitive(const QStyleOption *option, QPainter *pai
         const auto &background = palette.color(QPalette::Base);
         const auto outline(hasHighlightNeutral(widget, option, mouseOver, hasFocus) ? _helper->neutralText(palette).lighter(mouseOver || hasFocus ? 150 : 100)
                                                                                     : _helper->frameOutlineColor(palette, mouseOver, hasFocus, opacity, mode));
-        _helper->renderFrame(painter, rect, background, outline);
+        _helper->renderFrame(painter, rect, background, outline, mode != AnimationNone);
     }
 
     return true;
@@ -8632,133 +8695,8 @@ QIcon Style::titleBarButtonIcon(StandardPixmap standardPixmap, const QStyleOptio
         palette = QApplication::palette();
     }
 
-    //generate a different DecorationColors for buttons on a toolbar. These set the titlebar background to the toolbar background, and use the inactive button states
-    DecorationColors decorationColorsToolbar(false, true);
-    palette.setCurrentColorGroup(QPalette::Active);
-    const QColor toolbarBase(palette.color(QPalette::Window));
-    const QColor toolbarText(KColorUtils::mix(toolbarBase, palette.color(QPalette::WindowText), 0.7));
-    //generate inactive decoration colours only
-    decorationColorsToolbar.generateDecorationColors(palette, _helper->decorationConfig(), QColor(), QColor(), toolbarText, toolbarBase, "", true, false);
-    DecorationButtonPalette decorationButtonPaletteToolbar(buttonType);
-    decorationButtonPaletteToolbar.generate(_helper->decorationConfig(),
-                                            _helper->decorationColors()->active(),
-                                            decorationColorsToolbar.inactive(),
-                                            true,
-                                            false); // generate inactive button colours only);
-
-    // active button states which are used for MDI titlebars only
-    DecorationButtonPalette decorationButtonPaletteMdi(buttonType);
-    decorationButtonPaletteMdi.generate(_helper->decorationConfig(),
-                                        _helper->decorationColors()->active(),
-                                        decorationColorsToolbar.inactive(),
-                                        true,
-                                        true); // generate active button colours only
-
-    // convenience class to map color to icon mode
-    struct IconData {
-        QIcon::Mode _mode;
-        QIcon::State _state;
-        QColor _foregroundColor;
-        bool _cutOutForeground;
-        QColor _backgroundColor;
-        QColor _outlineColor;
-    };
-
-    // map colors to icon states
-    const QList<IconData> iconTypes = {
-        // state off icons
-        {QIcon::Normal, // used for standard widgets and inactive MDI window titlebars (hence using inactive colours)
-         QIcon::Off,
-         decorationButtonPaletteToolbar.inactive()->foregroundNormal,
-         decorationButtonPaletteToolbar.inactive()->cutOutForegroundNormal,
-         decorationButtonPaletteToolbar.inactive()->backgroundNormal,
-         decorationButtonPaletteToolbar.inactive()->outlineNormal},
-
-        {QIcon::Selected, // used for active MDI window titlebars
-         QIcon::Off,
-         decorationButtonPaletteMdi.active()->foregroundNormal,
-         decorationButtonPaletteMdi.active()->cutOutForegroundNormal,
-         decorationButtonPaletteMdi.active()->backgroundNormal,
-         decorationButtonPaletteMdi.active()->outlineNormal},
-
-        {QIcon::Active, // hover colours, standard widgets and inactive MDI titlebars
-         QIcon::Off,
-         decorationButtonPaletteToolbar.inactive()->foregroundHover,
-         decorationButtonPaletteToolbar.inactive()->cutOutForegroundHover,
-         decorationButtonPaletteToolbar.inactive()->backgroundHover,
-         decorationButtonPaletteToolbar.inactive()->outlineHover},
-
-        {QIcon::Disabled,
-         QIcon::Off,
-         ColorTools::alphaMix(decorationButtonPaletteToolbar.inactive()->foregroundNormal, 0.2),
-         false,
-         ColorTools::alphaMix(decorationButtonPaletteToolbar.inactive()->backgroundNormal, 0.2),
-         ColorTools::alphaMix(decorationButtonPaletteToolbar.inactive()->outlineNormal, 0.2)},
-
-        // state on icons
-        {QIcon::Normal, // Pressed colours on a standard widget / inactive
-         QIcon::On,
-         decorationButtonPaletteToolbar.inactive()->foregroundPress,
-         decorationButtonPaletteToolbar.inactive()->cutOutForegroundPress,
-         decorationButtonPaletteToolbar.inactive()->backgroundPress,
-         decorationButtonPaletteToolbar.inactive()->outlinePress},
-
-        {QIcon::Selected, // Pressed colours on MDI active titlebar
-         QIcon::On,
-         decorationButtonPaletteMdi.active()->foregroundPress,
-         decorationButtonPaletteMdi.active()->cutOutForegroundPress,
-         decorationButtonPaletteMdi.active()->backgroundPress,
-         decorationButtonPaletteMdi.active()->outlinePress},
-
-        {QIcon::Active, // Same as Normal::On -- needed like this for compatibility in drawToolButtonLabelControl
-         QIcon::On,
-         decorationButtonPaletteToolbar.inactive()->foregroundPress,
-         decorationButtonPaletteToolbar.inactive()->cutOutForegroundPress,
-         decorationButtonPaletteToolbar.inactive()->backgroundPress,
-         decorationButtonPaletteToolbar.inactive()->outlinePress},
-
-        // This is unused elsewhere, so use instead for Hovered on an active MDI titlebar (drawTitleBarComplexControl modified to use this in Klassy)
-        {QIcon::Disabled,
-         QIcon::On,
-         decorationButtonPaletteMdi.active()->foregroundHover,
-         decorationButtonPaletteMdi.active()->cutOutForegroundHover,
-         decorationButtonPaletteMdi.active()->backgroundHover,
-         decorationButtonPaletteMdi.active()->outlineHover},
-
-    };
-
-    // default icon sizes
-    static const QList<int> iconSizes = {8, 16, 22, 32, 48};
-
-    // output icon
-    QIcon icon;
-
-    for (const IconData &iconData : iconTypes) {
-        for (const int &iconSize : iconSizes) {
-            // create pixmap
-            QPixmap pixmap(iconSize, iconSize);
-            pixmap.fill(Qt::transparent);
-
-            // create painter and render
-            QPainter painter(&pixmap);
-            _helper->renderDecorationButton(&painter,
-                                            pixmap.rect(),
-                                            buttonType,
-                                            buttonChecked,
-                                            iconData._foregroundColor,
-                                            iconData._cutOutForeground,
-                                            iconData._backgroundColor,
-                                            iconData._outlineColor,
-                                            palette);
-
-            painter.end();
-
-            // store
-            icon.addPixmap(pixmap, iconData._mode, iconData._state);
-        }
-    }
-
-    return icon;
+    // colours are generated and each pixmap rendered only when an icon size, scale, mode and state is first requested
+    return QIcon(new TitleBarButtonIconEngine(_helper, buttonType, buttonChecked, palette));
 }
 
 void Style::generateDecorationColorsOnDecorationColorSettingsUpdate(QByteArray uuid)
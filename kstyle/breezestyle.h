@@ -177,6 +177,12 @@ private:
 
     bool isTabletMode() const;
 
+    //* computes pixel metrics, called by pixelMetric when the metric is not memoized
+    int pixelMetricImplementation(PixelMetric, const QStyleOption *, const QWidget *) const;
+
+    //* true if the metric depends on neither option nor widget, and can therefore be memoized in _pixelMetricCache
+    static bool isOptionIndependentMetric(PixelMetric, const QStyleOption *);
+
     //*@name subelementRect specialized functions
     //@{
 
@@ -525,6 +531,10 @@ private:
     using IconCache = QHash<StandardPixmap, QIcon>;
     IconCache _iconCache;
 
+    //* memoized option independent pixel metrics, flushed when the configuration, icon sizes or tablet mode change
+    using PixelMetricCache = QHash<PixelMetric, int>;
+    mutable PixelMetricCache _pixelMetricCache;
+
     //* pointer to primitive specialized function
     using StylePrimitive = std::function<bool(const Style &, const QStyleOption *, QPainter *, const QWidget *)>;
     StylePrimitive _frameFocusPrimitive;
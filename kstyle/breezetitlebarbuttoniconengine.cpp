@@ -0,0 +1,176 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Paul A McAuley <kde@paulmcauley.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "breezetitlebarbuttoniconengine.h"
+#include "breezehelper.h"
+#include "colortools.h"
+#include "decorationbuttoncolors.h"
+#include "decorationcolors.h"
+
+#include <KColorUtils>
+
+#include <QPainter>
+
+namespace Breeze
+{
+
+//____________________________________________________________________________________
+TitleBarButtonIconEngine::TitleBarButtonIconEngine(std::shared_ptr<Helper> helper,
+                                                   DecorationButtonType buttonType,
+                                                   bool buttonChecked,
+                                                   const QPalette &palette)
+    : m_helper(helper)
+    , m_buttonType(buttonType)
+    , m_buttonChecked(buttonChecked)
+    , m_palette(palette)
+{
+}
+
+//____________________________________________________________________________________
+void TitleBarButtonIconEngine::paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state)
+{
+    const qreal scale = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+    painter->drawPixmap(rect, renderPixmap(rect.size(), mode, state, scale));
+}
+
+//____________________________________________________________________________________
+QPixmap TitleBarButtonIconEngine::pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state)
+{
+    return renderPixmap(size, mode, state, 1.0);
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+//____________________________________________________________________________________
+QPixmap TitleBarButtonIconEngine::scaledPixmap(const QSize &size, QIcon::Mode mode, QIcon::State state, qreal scale)
+{
+    return renderPixmap(size, mode, state, scale);
+}
+#else
+//____________________________________________________________________________________
+void TitleBarButtonIconEngine::virtual_hook(int id, void *data)
+{
+    if (id == QIconEngine::ScaledPixmapHook) {
+        auto *arg = static_cast<QIconEngine::ScaledPixmapArgument *>(data);
+        arg->pixmap = renderPixmap(arg->size, arg->mode, arg->state, arg->scale > 0 ? arg->scale : 1.0);
+        return;
+    }
+    QIconEngine::virtual_hook(id, data);
+}
+#endif
+
+//____________________________________________________________________________________
+QIconEngine *TitleBarButtonIconEngine::clone() const
+{
+    return new TitleBarButtonIconEngine(*this);
+}
+
+//____________________________________________________________________________________
+QString TitleBarButtonIconEngine::key() const
+{
+    return QStringLiteral("KlassyTitleBarButton");
+}
+
+//____________________________________________________________________________________
+QPixmap TitleBarButtonIconEngine::renderPixmap(const QSize &size, QIcon::Mode mode, QIcon::State state, qreal scale)
+{
+    if (size.isEmpty()) {
+        return QPixmap();
+    }
+
+    const quint64 key = (quint64(size.width()) << 48) | (quint64(size.height()) << 32) | (quint64(qRound(scale * 1000)) << 8) | (quint64(mode) << 1)
+        | (state == QIcon::On ? 1 : 0);
+    auto cached = m_pixmaps.constFind(key);
+    if (cached != m_pixmaps.constEnd()) {
+        return cached.value();
+    }
+
+    if (!m_colorsGenerated) {
+        generateColors();
+    }
+    const ButtonColors &colors = m_colors[colorIndex(mode, state)];
+
+    // create pixmap
+    QPixmap pixmap(size * scale);
+    pixmap.setDevicePixelRatio(scale);
+    pixmap.fill(Qt::transparent);
+
+    // create painter and render
+    QPainter painter(&pixmap);
+    m_helper->renderDecorationButton(&painter,
+                                     QRect(QPoint(0, 0), size),
+                                     m_buttonType,
+                                     m_buttonChecked,
+                                     colors.foregroundColor,
+                                     colors.cutOutForeground,
+                                     colors.backgroundColor,
+                                     colors.outlineColor,
+                                     m_palette);
+    painter.end();
+
+    m_pixmaps.insert(key, pixmap);
+    return pixmap;
+}
+
+//____________________________________________________________________________________
+void TitleBarButtonIconEngine::generateColors()
+{
+    QPalette palette(m_palette);
+
+    // generate a different DecorationColors for buttons on a toolbar. These set the titlebar background to the toolbar background, and use the inactive button
+    // states
+    DecorationColors decorationColorsToolbar(false, true);
+    palette.setCurrentColorGroup(QPalette::Active);
+    const QColor toolbarBase(palette.color(QPalette::Window));
+    const QColor toolbarText(KColorUtils::mix(toolbarBase, palette.color(QPalette::WindowText), 0.7));
+    // generate inactive decoration colours only
+    decorationColorsToolbar.generateDecorationColors(palette, m_helper->decorationConfig(), QColor(), QColor(), toolbarText, toolbarBase, "", true, false);
+    DecorationButtonPalette decorationButtonPaletteToolbar(m_buttonType);
+    decorationButtonPaletteToolbar.generate(m_helper->decorationConfig(),
+                                            m_helper->decorationColors()->active(),
+                                            decorationColorsToolbar.inactive(),
+                                            true,
+                                            false); // generate inactive button colours only
+
+    // active button states which are used for MDI titlebars only
+    DecorationButtonPalette decorationButtonPaletteMdi(m_buttonType);
+    decorationButtonPaletteMdi.generate(m_helper->decorationConfig(),
+                                        m_helper->decorationColors()->active(),
+                                        decorationColorsToolbar.inactive(),
+                                        true,
+                                        true); // generate active button colours only
+
+    const DecorationButtonPaletteGroup *toolbar = decorationButtonPaletteToolbar.inactive();
+    const DecorationButtonPaletteGroup *mdi = decorationButtonPaletteMdi.active();
+
+    // state off icons
+    // used for standard widgets and inactive MDI window titlebars (hence using inactive colours)
+    m_colors[colorIndex(QIcon::Normal, QIcon::Off)] =
+        {toolbar->foregroundNormal, toolbar->cutOutForegroundNormal, toolbar->backgroundNormal, toolbar->outlineNormal};
+    // used for active MDI window titlebars
+    m_colors[colorIndex(QIcon::Selected, QIcon::Off)] = {mdi->foregroundNormal, mdi->cutOutForegroundNormal, mdi->backgroundNormal, mdi->outlineNormal};
+    // hover colours, standard widgets and inactive MDI titlebars
+    m_colors[colorIndex(QIcon::Active, QIcon::Off)] =
+        {toolbar->foregroundHover, toolbar->cutOutForegroundHover, toolbar->backgroundHover, toolbar->outlineHover};
+    m_colors[colorIndex(QIcon::Disabled, QIcon::Off)] = {ColorTools::alphaMix(toolbar->foregroundNormal, 0.2),
+                                                         false,
+                                                         ColorTools::alphaMix(toolbar->backgroundNormal, 0.2),
+                                                         ColorTools::alphaMix(toolbar->outlineNormal, 0.2)};
+
+    // state on icons
+    // Pressed colours on a standard widget / inactive
+    m_colors[colorIndex(QIcon::Normal, QIcon::On)] =
+        {toolbar->foregroundPress, toolbar->cutOutForegroundPress, toolbar->backgroundPress, toolbar->outlinePress};
+    // Pressed colours on MDI active titlebar
+    m_colors[colorIndex(QIcon::Selected, QIcon::On)] = {mdi->foregroundPress, mdi->cutOutForegroundPress, mdi->backgroundPress, mdi->outlinePress};
+    // Same as Normal::On -- needed like this for compatibility in drawToolButtonLabelControl
+    m_colors[colorIndex(QIcon::Active, QIcon::On)] = m_colors[colorIndex(QIcon::Normal, QIcon::On)];
+    // This is unused elsewhere, so use instead for Hovered on an active MDI titlebar (drawTitleBarComplexControl modified to use this in Klassy)
+    m_colors[colorIndex(QIcon::Disabled, QIcon::On)] = {mdi->foregroundHover, mdi->cutOutForegroundHover, mdi->backgroundHover, mdi->outlineHover};
+
+    m_colorsGenerated = true;
+}
+
+}
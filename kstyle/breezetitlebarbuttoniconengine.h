@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Paul A McAuley <kde@paulmcauley.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#pragma once
+
+#include "breeze.h"
+
+#include <QColor>
+#include <QHash>
+#include <QIconEngine>
+#include <QPalette>
+#include <QPixmap>
+
+#include <array>
+#include <memory>
+
+namespace Breeze
+{
+
+class Helper;
+
+/**
+ * @brief Icon engine for the title bar and dock widget buttons returned by Style::standardIcon().
+ *        Button colours are generated on the first render, and each (size, scale, mode, state) is only rendered when requested,
+ *        at the requested device pixel ratio, then memoized.
+ */
+class TitleBarButtonIconEngine : public QIconEngine
+{
+public:
+    //* constructor
+    TitleBarButtonIconEngine(std::shared_ptr<Helper> helper, DecorationButtonType buttonType, bool buttonChecked, const QPalette &palette);
+
+    void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state) override;
+    QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state) override;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QPixmap scaledPixmap(const QSize &size, QIcon::Mode mode, QIcon::State state, qreal scale) override;
+#else
+    void virtual_hook(int id, void *data) override;
+#endif
+    QIconEngine *clone() const override;
+    QString key() const override;
+
+private:
+    //* renders, or returns the memoized, pixmap of the given logical size at the given device pixel ratio
+    QPixmap renderPixmap(const QSize &size, QIcon::Mode mode, QIcon::State state, qreal scale);
+
+    //* generates the button colours for all modes and states
+    void generateColors();
+
+    //* colours of one mode and state
+    struct ButtonColors {
+        QColor foregroundColor;
+        bool cutOutForeground = false;
+        QColor backgroundColor;
+        QColor outlineColor;
+    };
+
+    //* index into m_colors for a mode and state
+    static int colorIndex(QIcon::Mode mode, QIcon::State state)
+    {
+        return int(mode) + (state == QIcon::On ? 4 : 0);
+    }
+
+    std::shared_ptr<Helper> m_helper;
+    DecorationButtonType m_buttonType;
+    bool m_buttonChecked;
+    QPalette m_palette;
+
+    bool m_colorsGenerated = false;
+    std::array<ButtonColors, 8> m_colors;
+
+    //* rendered pixmaps, keyed by size, scale, mode and state
+    QHash<quint64, QPixmap> m_pixmaps;
+};
+
+}
@@ -0,0 +1,202 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Paul A McAuley <kde@paulmcauley.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "colortools.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+
+Q_DECLARE_METATYPE(QImage::Format)
+
+using namespace Breeze;
+
+class ColorToolsTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void convertAlphaToColor_data();
+    void convertAlphaToColor();
+    void convertAlphaToColorPerPixel_data();
+    void convertAlphaToColorPerPixel();
+    void benchmarkConvertAlphaToColor_data();
+    void benchmarkConvertAlphaToColor();
+};
+
+//* the per-pixel loop convertAlphaToColor used before tinting whole scanlines, kept as a reference
+static void convertAlphaToColorPerPixel(QImage &image, const QColor tintColor)
+{
+    if (image.isNull())
+        return;
+    image.convertTo(QImage::Format_ARGB32);
+
+    QColor outputColor(tintColor);
+    int alpha;
+
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            alpha = qAlpha(line[x]);
+            if (alpha > 0) {
+                outputColor.setAlphaF((qreal(alpha) / 255) * tintColor.alphaF());
+                line[x] = outputColor.rgba();
+            }
+        }
+    }
+}
+
+//* multiplies an 8-bit value by alpha / 255, rounded, as the scalar path of ColorTools does
+static uint byteMul(const uint value, const uint alpha)
+{
+    const uint t = value * alpha + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+//* ARGB32 image of the given size with random colours and alphas, including fully transparent and opaque pixels
+static QImage randomImage(const QSize &size, QRandomGenerator &generator)
+{
+    QImage image(size, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            const quint32 value(generator.generate());
+            const int alpha((x % 5 == 0) ? 0 : (x % 7 == 0) ? 255 : int(value >> 24));
+            line[x] = (QRgb(alpha) << 24) | (value & RGB_MASK);
+        }
+    }
+    return image;
+}
+
+void ColorToolsTest::convertAlphaToColor_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<QColor>("tintColor");
+
+    const QList<QImage::Format> formats = {QImage::Format_ARGB32,
+                                           QImage::Format_ARGB32_Premultiplied,
+                                           QImage::Format_Alpha8,
+                                           QImage::Format_RGBA8888};
+    const QList<QColor> tintColors = {QColor(255, 255, 255), QColor(61, 174, 233, 128), QColor(0, 0, 0, 1)};
+    for (const QImage::Format format : formats) {
+        for (const QColor &tintColor : tintColors) {
+            QTest::addRow("format %d, tint %s", int(format), qPrintable(tintColor.name(QColor::HexArgb))) << format << tintColor;
+        }
+    }
+}
+
+void ColorToolsTest::convertAlphaToColor()
+{
+    QFETCH(QImage::Format, format);
+    QFETCH(QColor, tintColor);
+
+    QRandomGenerator generator(int(format));
+
+    // widths from 1 to 19 exercise both the four pixel SIMD loop and every length of the scalar tail
+    for (int width = 1; width <= 19; ++width) {
+        const QImage source(randomImage(QSize(width, 3), generator).convertToFormat(format));
+        QImage image(source);
+        ColorTools::convertAlphaToColor(image, tintColor);
+
+        const bool unpremultiplied(format == QImage::Format_ARGB32);
+        QCOMPARE(image.format(), unpremultiplied ? QImage::Format_ARGB32 : QImage::Format_ARGB32_Premultiplied);
+        QCOMPARE(image.size(), source.size());
+
+        const QImage sourceArgb(source.convertToFormat(QImage::Format_ARGB32));
+        const QRgb tint(unpremultiplied ? tintColor.rgba() : qPremultiply(tintColor.rgba()));
+        for (int y = 0; y < image.height(); ++y) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+            const QRgb *sourceLine = reinterpret_cast<const QRgb *>(sourceArgb.constScanLine(y));
+            for (int x = 0; x < image.width(); ++x) {
+                const uint alpha(qAlpha(sourceLine[x]));
+                QRgb expected;
+                if (unpremultiplied) {
+                    expected = alpha ? (byteMul(alpha, qAlpha(tint)) << 24) | (tint & RGB_MASK) : sourceLine[x];
+                } else {
+                    expected = qRgba(byteMul(qRed(tint), alpha), byteMul(qGreen(tint), alpha), byteMul(qBlue(tint), alpha), byteMul(qAlpha(tint), alpha));
+                }
+
+                if (line[x] != expected) {
+                    QFAIL(qPrintable(QStringLiteral("width %1, pixel (%2, %3): got %4, expected %5")
+                                         .arg(width)
+                                         .arg(x)
+                                         .arg(y)
+                                         .arg(line[x], 8, 16, QLatin1Char('0'))
+                                         .arg(expected, 8, 16, QLatin1Char('0'))));
+                }
+            }
+        }
+    }
+}
+
+void ColorToolsTest::convertAlphaToColorPerPixel_data()
+{
+    QTest::addColumn<QColor>("tintColor");
+
+    QTest::newRow("opaque") << QColor(255, 255, 255);
+    QTest::newRow("translucent") << QColor(61, 174, 233, 128);
+    QTest::newRow("nearly transparent") << QColor(0, 0, 0, 1);
+}
+
+void ColorToolsTest::convertAlphaToColorPerPixel()
+{
+    QFETCH(QColor, tintColor);
+
+    // ARGB32 output must match the former per-pixel loop, give or take the rounding of QColor's 16-bit alpha
+    QRandomGenerator generator(1);
+    const QImage source(randomImage(QSize(67, 5), generator));
+    QImage image(source);
+    QImage reference(source);
+    ColorTools::convertAlphaToColor(image, tintColor);
+    convertAlphaToColorPerPixel(reference, tintColor);
+
+    for (int y = 0; y < image.height(); ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        const QRgb *referenceLine = reinterpret_cast<const QRgb *>(reference.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            QCOMPARE(line[x] & RGB_MASK, referenceLine[x] & RGB_MASK);
+            QVERIFY(qAbs(qAlpha(line[x]) - qAlpha(referenceLine[x])) <= 1);
+        }
+    }
+}
+
+void ColorToolsTest::benchmarkConvertAlphaToColor_data()
+{
+    QTest::addColumn<bool>("perPixel");
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<int>("size");
+
+    for (const int size : {16, 64, 256}) {
+        for (const QImage::Format format : {QImage::Format_ARGB32, QImage::Format_ARGB32_Premultiplied}) {
+            const char *formatName(format == QImage::Format_ARGB32 ? "ARGB32" : "ARGB32_Premultiplied");
+            QTest::addRow("per pixel, %s, %dx%d", formatName, size, size) << true << format << size;
+            QTest::addRow("scanline, %s, %dx%d", formatName, size, size) << false << format << size;
+        }
+    }
+}
+
+void ColorToolsTest::benchmarkConvertAlphaToColor()
+{
+    QFETCH(bool, perPixel);
+    QFETCH(QImage::Format, format);
+    QFETCH(int, size);
+
+    QRandomGenerator generator(size);
+    const QImage source(randomImage(QSize(size, size), generator).convertToFormat(format));
+    const QColor tintColor(61, 174, 233, 200);
+
+    QBENCHMARK {
+        QImage image(source);
+        if (perPixel) {
+            convertAlphaToColorPerPixel(image, tintColor);
+        } else {
+            ColorTools::convertAlphaToColor(image, tintColor);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(ColorToolsTest)
+
+#include "colortoolstest.moc"
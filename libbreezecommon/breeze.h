@@ -28,6 +28,12 @@ namespace Breeze
 
 QString BREEZECOMMON_EXPORT klassyLongVersion();
 
+//* mixes the hash of one more field into seed, for hashing composite cache keys; qHashMulti is only available from Qt 6
+constexpr size_t hashCombine(size_t seed, size_t hash)
+{
+    return seed ^ (hash + size_t(0x9e3779b9) + (seed << 6) + (seed >> 2));
+}
+
 //* standard pen widths
 struct BREEZECOMMON_EXPORT PenWidth {
     /* Using 1 instead of slightly more than 1 causes symbols drawn with
@@ -20,8 +20,18 @@
 
 // Qt
 #include <QPainter>
+#include <QVarLengthArray>
 #include <QtMath>
 
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
 namespace Breeze
 {
 
@@ -163,9 +173,188 @@ static inline void boxBlurRowAlpha(const uint8_t *src,
     }
 }
 
+#ifdef __SSE2__
+/**
+ * Multiply packed 32-bit integers, keeping the low 32 bits of each product.
+ **/
+static inline __m128i mulLo32(__m128i a, __m128i b)
+{
+#ifdef __SSE4_1__
+    return _mm_mullo_epi32(a, b);
+#else
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+/**
+ * Load 16 alpha values and widen them to four vectors of 32-bit integers.
+ **/
+static inline void loadAlpha16(const uint8_t *src, __m128i values[4])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+    const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+    values[0] = _mm_unpacklo_epi16(low, zero);
+    values[1] = _mm_unpackhi_epi16(low, zero);
+    values[2] = _mm_unpacklo_epi16(high, zero);
+    values[3] = _mm_unpackhi_epi16(high, zero);
+}
+
+/**
+ * Store 16 averaged alpha values, computed exactly as boxBlurRowAlpha() does.
+ **/
+static inline void storeAlpha16(uint8_t *dst, const __m128i sums[4], __m128i reciprocal)
+{
+    __m128i values[4];
+    for (int i = 0; i < 4; ++i) {
+        values[i] = _mm_srli_epi32(mulLo32(sums[i], reciprocal), 24);
+    }
+
+    // every value is at most 255, so the saturating packs are exact
+    const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(values[0], values[1]), _mm_packs_epi32(values[2], values[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), packed);
+}
+
+/**
+ * Process 16 adjacent columns of an alpha plane with a box filter.
+ *
+ * This is boxBlurRowAlpha() with one column per SIMD lane, so each step only
+ * touches one contiguous run of 16 bytes per row.
+ *
+ * @param src The top of the first column.
+ * @param dst The destination.
+ * @param height The height of the columns, in pixels.
+ * @param stride The number of bytes from one row to the next row.
+ * @param lobes Params of the box filter.
+ **/
+static inline void boxBlurColumns16Alpha(const uint8_t *src, uint8_t *dst, int height, int stride, const BoxLobes &lobes)
+{
+    const int boxSize = lobes.left + 1 + lobes.right;
+    const __m128i reciprocal = _mm_set1_epi32((1 << 24) / boxSize);
+
+    __m128i firstValues[4];
+    __m128i lastValues[4];
+    loadAlpha16(src, firstValues);
+    loadAlpha16(src + (height - 1) * stride, lastValues);
+
+    __m128i alphaSums[4];
+    for (int i = 0; i < 4; ++i) {
+        alphaSums[i] = _mm_add_epi32(_mm_set1_epi32((boxSize + 1) / 2), mulLo32(firstValues[i], _mm_set1_epi32(lobes.left)));
+    }
+
+    __m128i leftValues[4];
+    __m128i rightValues[4];
+    int left = 0;
+    int right = 0;
+    int out = 0;
+
+    for (; right < boxSize - lobes.left; ++right) {
+        loadAlpha16(src + right * stride, rightValues);
+        for (int i = 0; i < 4; ++i) {
+            alphaSums[i] = _mm_add_epi32(alphaSums[i], rightValues[i]);
+        }
+    }
+
+    for (; right < boxSize; ++right, ++out) {
+        storeAlpha16(dst + out * stride, alphaSums, reciprocal);
+        loadAlpha16(src + right * stride, rightValues);
+        for (int i = 0; i < 4; ++i) {
+            alphaSums[i] = _mm_sub_epi32(_mm_add_epi32(alphaSums[i], rightValues[i]), firstValues[i]);
+        }
+    }
+
+    for (; right < height; ++right, ++left, ++out) {
+        storeAlpha16(dst + out * stride, alphaSums, reciprocal);
+        loadAlpha16(src + right * stride, rightValues);
+        loadAlpha16(src + left * stride, leftValues);
+        for (int i = 0; i < 4; ++i) {
+            alphaSums[i] = _mm_sub_epi32(_mm_add_epi32(alphaSums[i], rightValues[i]), leftValues[i]);
+        }
+    }
+
+    for (; out < height; ++left, ++out) {
+        storeAlpha16(dst + out * stride, alphaSums, reciprocal);
+        loadAlpha16(src + left * stride, leftValues);
+        for (int i = 0; i < 4; ++i) {
+            alphaSums[i] = _mm_sub_epi32(_mm_add_epi32(alphaSums[i], lastValues[i]), leftValues[i]);
+        }
+    }
+}
+#endif
+
+/**
+ * Process all columns of a tightly packed alpha plane with a box filter.
+ *
+ * @param src The alpha plane.
+ * @param dst The destination plane, it must not overlap @p src.
+ * @param width The number of columns.
+ * @param height The number of rows.
+ * @param stride The number of bytes from one row to the next row.
+ * @param lobes Params of the box filter.
+ **/
+static void boxBlurColumnsAlpha(const uint8_t *src, uint8_t *dst, int width, int height, int stride, const BoxLobes &lobes)
+{
+    int column = 0;
+
+#ifdef __SSE2__
+    for (; column + 16 <= width; column += 16) {
+        boxBlurColumns16Alpha(src + column, dst + column, height, stride, lobes);
+    }
+#endif
+
+    // remaining columns, or all of them without SIMD support
+    for (; column < width; ++column) {
+        boxBlurRowAlpha(src + column, dst + column, height, 1, stride, lobes, true, true);
+    }
+}
+
+/**
+ * Copy alpha values into a tightly packed plane, transposing them.
+ *
+ * The copy is done in square tiles so that both the reads and the writes stay
+ * within a few cache lines.
+ *
+ * @param src The first alpha value.
+ * @param srcPixelStride The number of bytes from one alpha value to the next.
+ * @param srcRowStride The number of bytes from one source row to the next.
+ * @param dst The destination plane, with one byte per alpha value.
+ * @param dstRowStride The number of bytes from one destination row to the next.
+ * @param width The number of source columns.
+ * @param height The number of source rows.
+ **/
+static void transposeAlpha(const uint8_t *src, int srcPixelStride, int srcRowStride, uint8_t *dst, int dstRowStride, int width, int height)
+{
+    constexpr int tileSize = 32;
+
+    for (int tileY = 0; tileY < height; tileY += tileSize) {
+        const int tileBottom = qMin(tileY + tileSize, height);
+
+        for (int tileX = 0; tileX < width; tileX += tileSize) {
+            const int tileRight = qMin(tileX + tileSize, width);
+
+            for (int y = tileY; y < tileBottom; ++y) {
+                const uint8_t *in = src + y * srcRowStride + tileX * srcPixelStride;
+                uint8_t *out = dst + tileX * dstRowStride + y;
+
+                for (int x = tileX; x < tileRight; ++x, in += srcPixelStride, out += dstRowStride) {
+                    *out = *in;
+                }
+            }
+        }
+    }
+}
+
 /**
  * Blur the alpha channel of a given image.
  *
+ * The alpha channel is first copied into a transposed, tightly packed plane, so
+ * that the horizontal passes run down columns like the vertical passes do. Each
+ * pass then processes many adjacent columns at once, reading whole rows of the
+ * plane, which gives exactly the same result as blurring one row at a time.
+ *
  * @param image The input image.
  * @param radius The blur radius.
  * @param rect Specifies what part of the image to blur. If nothing is provided, then
@@ -187,25 +376,129 @@ static inline void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {
     const int rowStride = image.bytesPerLine();
     const int pixelStride = image.depth() >> 3;
 
-    const int bufferStride = qMax(width, height) * pixelStride;
-    QScopedPointer<uint8_t, QScopedPointerArrayDeleter<uint8_t>> buf(new uint8_t[2 * bufferStride]);
-    uint8_t *buf1 = buf.data();
-    uint8_t *buf2 = buf1 + bufferStride;
-
-    // Blur the image in horizontal direction.
-    for (int i = 0; i < height; ++i) {
-        uint8_t *row = image.scanLine(blurRect.y() + i) + blurRect.x() * pixelStride + alphaOffset;
-        boxBlurRowAlpha(row, buf1, width, pixelStride, rowStride, lobes[0], false, false);
-        boxBlurRowAlpha(buf1, buf2, width, pixelStride, rowStride, lobes[1], false, false);
-        boxBlurRowAlpha(buf2, row, width, pixelStride, rowStride, lobes[2], false, false);
-    }
+    uint8_t *alpha = image.scanLine(blurRect.y()) + blurRect.x() * pixelStride + alphaOffset;
+
+    const int planeSize = width * height;
+    QScopedPointer<uint8_t, QScopedPointerArrayDeleter<uint8_t>> buf(new uint8_t[2 * planeSize]);
+    uint8_t *plane1 = buf.data();
+    uint8_t *plane2 = plane1 + planeSize;
+
+    // Blur the image in horizontal direction: image rows are plane columns.
+    transposeAlpha(alpha, pixelStride, rowStride, plane1, height, width, height);
+    boxBlurColumnsAlpha(plane1, plane2, height, width, height, lobes[0]);
+    boxBlurColumnsAlpha(plane2, plane1, height, width, height, lobes[1]);
+    boxBlurColumnsAlpha(plane1, plane2, height, width, height, lobes[2]);
 
     // Blur the image in vertical direction.
-    for (int i = 0; i < width; ++i) {
-        uint8_t *column = image.scanLine(blurRect.y()) + (blurRect.x() + i) * pixelStride + alphaOffset;
-        boxBlurRowAlpha(column, buf1, height, pixelStride, rowStride, lobes[0], true, false);
-        boxBlurRowAlpha(buf1, buf2, height, pixelStride, rowStride, lobes[1], false, false);
-        boxBlurRowAlpha(buf2, column, height, pixelStride, rowStride, lobes[2], false, true);
+    transposeAlpha(plane2, 1, height, plane1, width, height, width);
+    boxBlurColumnsAlpha(plane1, plane2, width, height, width, lobes[0]);
+    boxBlurColumnsAlpha(plane2, plane1, width, height, width, lobes[1]);
+    boxBlurColumnsAlpha(plane1, plane2, width, height, width, lobes[2]);
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *in = plane2 + y * width;
+        uint8_t *out = alpha + y * rowStride;
+
+        for (int x = 0; x < width; ++x, out += pixelStride) {
+            *out = in[x];
+        }
+    }
+}
+
+/**
+ * Compute the standard deviation of the Gaussian that is approximated by
+ * successively applying the given box filters.
+ *
+ * @param lobes Params of the box filters.
+ **/
+static qreal calculateLobesStdDev(const QVector<BoxLobes> &lobes)
+{
+    qreal variance = 0.0;
+    for (const BoxLobes &lobe : lobes) {
+        const int boxSize = lobe.left + 1 + lobe.right;
+        variance += (boxSize * boxSize - 1) / 12.0;
+    }
+    return qSqrt(variance);
+}
+
+/**
+ * Compute the part of a 1D Gaussian centered at @p x that lies within [from, to].
+ **/
+static inline qreal gaussianCoverage(qreal x, qreal from, qreal to, qreal stdDev)
+{
+    const qreal scale = 1.0 / (stdDev * M_SQRT2);
+    return 0.5 * (std::erf((to - x) * scale) - std::erf((from - x) * scale));
+}
+
+/**
+ * Render the top-left quadrant of a blurred box in closed form.
+ *
+ * A Gaussian blurred rectangle is separable, so away from the corner it is the
+ * product of two erf profiles. The rounded top-left corner is handled by subtracting
+ * the blurred notch between the corner's square and its ellipse, which is split into
+ * horizontal strips. The horizontal and vertical coverage of every strip are stored
+ * in two lookup tables, so the corner needs no erf evaluations per pixel. The other
+ * corners are too far away from the quadrant to contribute noticeably.
+ *
+ * @param image The image to render to, only its alpha channel is set.
+ * @param box The box, in device pixels.
+ * @param xRadius The horizontal radius of the box' corners, in device pixels.
+ * @param yRadius The vertical radius of the box' corners, in device pixels.
+ * @param stdDev The standard deviation of the blur, in device pixels.
+ **/
+static void renderAnalyticShadowAlpha(QImage &image, const QRectF &box, qreal xRadius, qreal yRadius, qreal stdDev)
+{
+    const int width = qCeil(image.width() * 0.5);
+    const int height = qCeil(image.height() * 0.5);
+
+    QVarLengthArray<qreal, 256> columnCoverage(width);
+    for (int x = 0; x < width; ++x) {
+        columnCoverage[x] = gaussianCoverage(x + 0.5, box.left(), box.right(), stdDev);
+    }
+
+    QVarLengthArray<qreal, 256> rowCoverage(height);
+    for (int y = 0; y < height; ++y) {
+        rowCoverage[y] = gaussianCoverage(y + 0.5, box.top(), box.bottom(), stdDev);
+    }
+
+    // Beyond three standard deviations the notch has no visible effect.
+    const int cornerWidth = xRadius > 0.0 && yRadius > 0.0 ? qMin(width, qCeil(box.left() + xRadius + 3.0 * stdDev)) : 0;
+    const int cornerHeight = cornerWidth > 0 ? qMin(height, qCeil(box.top() + yRadius + 3.0 * stdDev)) : 0;
+
+    const int stripCount = cornerWidth > 0 ? qCeil(yRadius * 2.0) : 0;
+    const qreal stripHeight = stripCount > 0 ? yRadius / stripCount : 0.0;
+
+    QVarLengthArray<qreal, 1024> notchColumnCoverage(stripCount * cornerWidth);
+    for (int strip = 0; strip < stripCount; ++strip) {
+        const qreal distance = (stripCount - strip - 0.5) / stripCount;
+        const qreal notchRight = box.left() + xRadius * (1.0 - qSqrt(1.0 - distance * distance));
+        for (int x = 0; x < cornerWidth; ++x) {
+            notchColumnCoverage[strip * cornerWidth + x] = gaussianCoverage(x + 0.5, box.left(), notchRight, stdDev);
+        }
+    }
+
+    QVarLengthArray<qreal, 1024> notchRowCoverage(cornerHeight * stripCount);
+    for (int y = 0; y < cornerHeight; ++y) {
+        for (int strip = 0; strip < stripCount; ++strip) {
+            const qreal stripTop = box.top() + strip * stripHeight;
+            notchRowCoverage[y * stripCount + strip] = gaussianCoverage(y + 0.5, stripTop, stripTop + stripHeight, stdDev);
+        }
+    }
+
+    for (int y = 0; y < height; ++y) {
+        QRgb *out = reinterpret_cast<QRgb *>(image.scanLine(y));
+
+        for (int x = 0; x < width; ++x) {
+            qreal coverage = columnCoverage[x] * rowCoverage[y];
+
+            if (x < cornerWidth && y < cornerHeight) {
+                for (int strip = 0; strip < stripCount; ++strip) {
+                    coverage -= notchRowCoverage[y * stripCount + strip] * notchColumnCoverage[strip * cornerWidth + x];
+                }
+            }
+
+            out[x] = qRgba(0, 0, 0, qBound(0, qRound(coverage * 255.0), 255));
+        }
     }
 }
 
@@ -239,7 +532,13 @@ static inline void mirrorTopLeftQuadrant(QImage &image)
     }
 }
 
-static void renderShadow(QPainter *painter, const QRect &rect, qreal borderRadius, const QPoint &offset, int radius, const QColor &color)
+static void renderShadow(QPainter *painter,
+                         const QRect &rect,
+                         qreal borderRadius,
+                         const QPoint &offset,
+                         int radius,
+                         const QColor &color,
+                         BoxShadowRenderer::Mode mode)
 {
     const QSize inflation = calculateBlurExtent(radius);
     const QSize size = rect.size() + 2 * inflation;
@@ -257,18 +556,25 @@ static void renderShadow(QPainter *painter, const QRect &rect, qreal borderRadiu
     const qreal yRadius = 2.0 * borderRadius / boxRect.height();
 
     QPainter shadowPainter;
-    shadowPainter.begin(&shadow);
-    shadowPainter.setRenderHint(QPainter::Antialiasing);
-    shadowPainter.setPen(Qt::NoPen);
-    shadowPainter.setBrush(Qt::black);
-    shadowPainter.drawRoundedRect(boxRect, xRadius, yRadius);
-    shadowPainter.end();
+    const int scaledRadius = qRound(radius * dpr);
 
-    // Because the shadow texture is symmetrical, that's enough to blur
+    // Because the shadow texture is symmetrical, that's enough to render
     // only the top-left quadrant and then mirror it.
-    const QRect blurRect(0, 0, qCeil(shadow.width() * 0.5), qCeil(shadow.height() * 0.5));
-    const int scaledRadius = qRound(radius * dpr);
-    boxBlurAlpha(shadow, scaledRadius, blurRect);
+    if (mode == BoxShadowRenderer::Mode::Analytic && scaledRadius >= 2) {
+        const QRectF deviceBoxRect(QPointF(boxRect.topLeft()) * dpr, QSizeF(boxRect.size()) * dpr);
+        const qreal stdDev = calculateLobesStdDev(computeLobes(scaledRadius));
+        renderAnalyticShadowAlpha(shadow, deviceBoxRect, xRadius * dpr, yRadius * dpr, stdDev);
+    } else {
+        shadowPainter.begin(&shadow);
+        shadowPainter.setRenderHint(QPainter::Antialiasing);
+        shadowPainter.setPen(Qt::NoPen);
+        shadowPainter.setBrush(Qt::black);
+        shadowPainter.drawRoundedRect(boxRect, xRadius, yRadius);
+        shadowPainter.end();
+
+        const QRect blurRect(0, 0, qCeil(shadow.width() * 0.5), qCeil(shadow.height() * 0.5));
+        boxBlurAlpha(shadow, scaledRadius, blurRect);
+    }
     mirrorTopLeftQuadrant(shadow);
 
     // Give the shadow a tint of the desired color.
@@ -294,6 +600,11 @@ void BoxShadowRenderer::setBorderRadius(qreal radius)
     m_borderRadius = radius;
 }
 
+void BoxShadowRenderer::setMode(Mode mode)
+{
+    m_mode = mode;
+}
+
 void BoxShadowRenderer::addShadow(const QPoint &offset, int radius, const QColor &color)
 {
     Shadow shadow = {};
@@ -322,7 +633,7 @@ QImage BoxShadowRenderer::render() const
 
     QPainter painter(&canvas);
     for (const Shadow &shadow : std::as_const(m_shadows)) {
-        renderShadow(&painter, boxRect, m_borderRadius, shadow.offset, shadow.radius, shadow.color);
+        renderShadow(&painter, boxRect, m_borderRadius, shadow.offset, shadow.radius, shadow.color, m_mode);
     }
     painter.end();
 
@@ -23,6 +23,14 @@ class BREEZECOMMON_EXPORT BoxShadowRenderer
 public:
     // Compiler generated constructors & destructor are fine.
 
+    /**
+     * How the blurred box is generated.
+     **/
+    enum class Mode {
+        BoxBlur, ///< draw the box and blur it with three box filters
+        Analytic, ///< evaluate the Gaussian blurred box in closed form, without any blur passes
+    };
+
     /**
      * Set the size of the box.
      * @param size The size of the box.
@@ -35,6 +43,17 @@ public:
      **/
     void setBorderRadius(qreal radius);
 
+    /**
+     * Set how the shadows are generated.
+     *
+     * Analytic shadows closely match box blurred ones but are much cheaper to
+     * create, which makes them suitable for shadows that are created on every
+     * animation frame.
+     *
+     * @param mode The mode, BoxBlur by default.
+     **/
+    void setMode(Mode mode);
+
     /**
      * Add a shadow.
      * @param offset The offset of the shadow.
@@ -73,6 +92,7 @@ public:
 private:
     QSize m_boxSize;
     qreal m_borderRadius = 0.0;
+    Mode m_mode = Mode::BoxBlur;
 
     struct Shadow {
         QPoint offset;
@@ -8,6 +8,12 @@
 #include <KColorUtils>
 #include <QIcon>
 
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace Breeze
 {
 
@@ -96,25 +102,135 @@ QColor ColorTools::alphaMix(const QColor &inputColor, const qreal &alphaMixFacto
     return outputColor;
 }
 
+//* multiplies an 8-bit value by alpha / 255, rounded -- the same arithmetic as the SSE2 path below
+static inline uint byteMul(const uint value, const uint alpha)
+{
+    const uint t = value * alpha + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+//* premultiplied tint colour scaled by each alpha in turn
+static inline QRgb tintPremultiplied(const QRgb tint, const uint alpha)
+{
+    return qRgba(byteMul(qRed(tint), alpha), byteMul(qGreen(tint), alpha), byteMul(qBlue(tint), alpha), byteMul(qAlpha(tint), alpha));
+}
+
+#ifdef __SSE2__
+//* for four alpha values in the low byte of each 32-bit lane, returns four pixels of the premultiplied tint scaled by those alphas
+static inline __m128i tintPremultiplied4(const __m128i alpha32, const __m128i tint16)
+{
+    const __m128i alpha16 = _mm_unpacklo_epi16(_mm_packs_epi32(alpha32, alpha32), _mm_packs_epi32(alpha32, alpha32)); // a0 a0 a1 a1 a2 a2 a3 a3
+    const __m128i alphaLo = _mm_unpacklo_epi32(alpha16, alpha16); // a0 x4, a1 x4
+    const __m128i alphaHi = _mm_unpackhi_epi32(alpha16, alpha16); // a2 x4, a3 x4
+    const __m128i rounding = _mm_set1_epi16(128);
+
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(tint16, alphaLo), rounding);
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(tint16, alphaHi), rounding);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    return _mm_packus_epi16(lo, hi);
+}
+#endif
+
+//* in-place tint of a premultiplied ARGB32 scanline, using the alpha of each pixel
+static void tintScanlinePremultiplied(QRgb *line, const int width, const QRgb tint)
+{
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i tint16 = _mm_unpacklo_epi8(_mm_set1_epi32(int(tint)), _mm_setzero_si128());
+    for (; x + 4 <= width; x += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(line + x), tintPremultiplied4(_mm_srli_epi32(pixels, 24), tint16));
+    }
+#endif
+    for (; x < width; ++x) {
+        line[x] = tintPremultiplied(tint, qAlpha(line[x]));
+    }
+}
+
+//* tint of an Alpha8 scanline into a premultiplied ARGB32 scanline
+static void tintScanlineAlpha8(QRgb *destination, const uchar *alpha, const int width, const QRgb tint)
+{
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i tint16 = _mm_unpacklo_epi8(_mm_set1_epi32(int(tint)), _mm_setzero_si128());
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 4 <= width; x += 4) {
+        int alpha4;
+        memcpy(&alpha4, alpha + x, sizeof(alpha4));
+        const __m128i alpha32 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(alpha4), zero), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + x), tintPremultiplied4(alpha32, tint16));
+    }
+#endif
+    for (; x < width; ++x) {
+        destination[x] = tintPremultiplied(tint, alpha[x]);
+    }
+}
+
+//* in-place tint of a non-premultiplied ARGB32 scanline; fully transparent pixels are left untouched
+static void tintScanlineUnpremultiplied(QRgb *line, const int width, const QRgb tint)
+{
+    const uint tintAlpha = qAlpha(tint);
+    const QRgb tintRgb = tint & RGB_MASK;
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i tintAlpha32 = _mm_set1_epi32(int(tintAlpha));
+    const __m128i tintRgb32 = _mm_set1_epi32(int(tintRgb));
+    const __m128i rounding = _mm_set1_epi32(128);
+    for (; x + 4 <= width; x += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + x));
+        const __m128i alpha32 = _mm_srli_epi32(pixels, 24);
+        // both factors are below 256, so the 16-bit multiply leaves the full product in each 32-bit lane
+        __m128i outputAlpha = _mm_add_epi32(_mm_mullo_epi16(alpha32, tintAlpha32), rounding);
+        outputAlpha = _mm_srli_epi32(_mm_add_epi32(outputAlpha, _mm_srli_epi32(outputAlpha, 8)), 8);
+        const __m128i tinted = _mm_or_si128(_mm_slli_epi32(outputAlpha, 24), tintRgb32);
+        const __m128i transparent = _mm_cmpeq_epi32(alpha32, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(line + x), _mm_or_si128(_mm_and_si128(transparent, pixels), _mm_andnot_si128(transparent, tinted)));
+    }
+#endif
+    for (; x < width; ++x) {
+        const uint alpha = qAlpha(line[x]);
+        if (alpha > 0) {
+            line[x] = (byteMul(alpha, tintAlpha) << 24) | tintRgb;
+        }
+    }
+}
+
 void ColorTools::convertAlphaToColor(QImage &image, const QColor tintColor)
 {
     if (image.isNull())
         return;
-    image.convertTo(QImage::Format_ARGB32);
-
-    QColor outputColor(tintColor);
-    int alpha;
-
-    for (int y = 0; y < image.height(); ++y) {
-        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
-        for (int x = 0; x < image.width(); ++x) {
-            // line[x] is a pixel
-            alpha = qAlpha(line[x]);
-            if (alpha > 0) {
-                outputColor.setAlphaF((qreal(alpha) / 255) * tintColor.alphaF());
-                line[x] = outputColor.rgba();
-            }
+
+    // Alpha8 and the ARGB32 formats are tinted directly; anything else is converted to premultiplied ARGB32 first
+    switch (image.format()) {
+    case QImage::Format_Alpha8: {
+        QImage tintedImage(image.size(), QImage::Format_ARGB32_Premultiplied);
+        tintedImage.setDevicePixelRatio(image.devicePixelRatio());
+        const QRgb tint = qPremultiply(tintColor.rgba());
+        for (int y = 0; y < image.height(); ++y) {
+            tintScanlineAlpha8(reinterpret_cast<QRgb *>(tintedImage.scanLine(y)), image.constScanLine(y), image.width(), tint);
         }
+        image = tintedImage;
+        return;
+    }
+    case QImage::Format_ARGB32: {
+        const QRgb tint = tintColor.rgba();
+        for (int y = 0; y < image.height(); ++y) {
+            tintScanlineUnpremultiplied(reinterpret_cast<QRgb *>(image.scanLine(y)), image.width(), tint);
+        }
+        return;
+    }
+    default:
+        image.convertTo(QImage::Format_ARGB32_Premultiplied);
+        Q_FALLTHROUGH();
+    case QImage::Format_ARGB32_Premultiplied: {
+        const QRgb tint = qPremultiply(tintColor.rgba());
+        for (int y = 0; y < image.height(); ++y) {
+            tintScanlinePremultiplied(reinterpret_cast<QRgb *>(image.scanLine(y)), image.width(), tint);
+        }
+        return;
+    }
     }
 }
 
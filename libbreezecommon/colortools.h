@@ -56,6 +56,14 @@ public:
      */
     static QColor alphaMix(const QColor &inputColor, const qreal &alphaMixFactor);
 
+    /**
+     * @brief Replaces the colour of every pixel of image by tintColor, keeping the pixel alpha scaled by the alpha of tintColor
+     *        ARGB32 images are tinted in place and stay ARGB32; their fully transparent pixels are left untouched.
+     *        Every other format, including Alpha8, is output as ARGB32_Premultiplied (it used to be ARGB32),
+     *        so fully transparent pixels come out as transparent black.
+     * @param image The image to tint, modified in place
+     * @param tintColor The colour to tint with
+     */
     static void convertAlphaToColor(QImage &image, const QColor tintColor);
 
     static void convertAlphaToColor(QIcon &icon, QSize iconSize, const QColor tintColor);
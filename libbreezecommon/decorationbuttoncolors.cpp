@@ -5,7 +5,9 @@
  */
 #include "decorationbuttoncolors.h"
 #include "colortools.h"
+#include "decorationcolors.h"
 #include <KColorUtils>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -13,11 +15,10 @@
 namespace Breeze
 {
 
+static quint64 s_buttonPaletteGenerationCounter = 0;
+
 DecorationButtonPalette::DecorationButtonPalette(DecorationButtonType buttonType)
     : _buttonType(buttonType)
-    , _active(std::make_shared<DecorationButtonPaletteGroup>())
-    , _inactive(std::make_shared<DecorationButtonPaletteGroup>())
-
 {
 }
 
@@ -27,6 +28,7 @@ void DecorationButtonPalette::generate(InternalSettingsPtr decorationSettings,
                                        const bool generateOneGroupOnly,
                                        const bool oneGroupActiveState)
 {
+    _generation = ++s_buttonPaletteGenerationCounter;
     _decorationSettings = decorationSettings;
     _decorationColorsActive = decorationColorsActive;
     _decorationColorsInactive = decorationColorsInactive;
@@ -48,122 +50,130 @@ void DecorationButtonPalette::generate(InternalSettingsPtr decorationSettings,
 
 void DecorationButtonPalette::decodeButtonOverrideColors(const bool active)
 {
-    QMap<OverridableButtonColorState, QColor> &buttonOverrideColors = active ? _buttonOverrideColorsActive : _buttonOverrideColorsInactive;
+    ButtonOverrideColors &buttonOverrideColors = active ? _buttonOverrideColorsActive : _buttonOverrideColorsInactive;
     bool &buttonOverrideColorsPresent = active ? _buttonOverrideColorsPresentActive : _buttonOverrideColorsPresentInactive;
 
-    buttonOverrideColors.clear();
+    buttonOverrideColors.fill(QColor());
     buttonOverrideColorsPresent = false;
 
-    bool overrideButtonTypeValid = false;
-    for (int i = 0; i < InternalSettings::EnumButtonOverrideColorsActiveButtonType::COUNT; i++) {
-        if (static_cast<int>(_buttonType) == i) {
-            overrideButtonTypeValid = true;
-            break;
-        }
-    }
-    if (!overrideButtonTypeValid) {
+    if (static_cast<int>(_buttonType) < 0 || static_cast<int>(_buttonType) >= InternalSettings::EnumButtonOverrideColorsActiveButtonType::COUNT) {
         return;
     }
 
-    QByteArray overrideColorsSetting = active ? _decorationSettings->buttonOverrideColorsActive(static_cast<int>(_buttonType)).toUtf8()
-                                              : _decorationSettings->buttonOverrideColorsInactive(static_cast<int>(_buttonType)).toUtf8();
+    const QString overrideColorsSetting = active ? _decorationSettings->buttonOverrideColorsActive(static_cast<int>(_buttonType))
+                                                 : _decorationSettings->buttonOverrideColorsInactive(static_cast<int>(_buttonType));
     if (overrideColorsSetting.isEmpty()) {
         return;
     }
 
-    QJsonDocument document = QJsonDocument::fromJson(overrideColorsSetting);
+    std::shared_ptr<const ButtonOverrideColorTable> table = decodedButtonOverrideColorTable(overrideColorsSetting);
+    if (!table->present) {
+        return;
+    }
 
+    // only the named colour items depend on the decoration palette, so this is all that is left to do per palette generation
+    for (size_t i = 0; i < table->entries.size(); i++) {
+        const ButtonOverrideColorEntry &entry = table->entries[i];
+        QColor color;
+        if (entry.colorItemIndex < 0) {
+            continue;
+        } else if (entry.colorItemIndex == 0) {
+            color = entry.customColor;
+        } else {
+            color = overrideColorItemsIndexToColor(_decorationColorsActive, _decorationColorsInactive, entry.colorItemIndex, active);
+            if (!color.isValid())
+                continue;
+            if (entry.opacity >= 0)
+                color.setAlphaF(entry.opacity / 100.0f);
+        }
+
+        buttonOverrideColors[i] = color;
+        buttonOverrideColorsPresent = true;
+    }
+}
+
+std::shared_ptr<const ButtonOverrideColorTable> DecorationButtonPalette::decodedButtonOverrideColorTable(const QString &overrideColorsSetting)
+{
+    // keyed by the raw setting string, so a settings reload with unchanged override colours reuses the previous tables
+    static QHash<QString, std::shared_ptr<const ButtonOverrideColorTable>> s_decodedTables;
+    static constexpr int maxDecodedTables = 64;
+
+    auto cached = s_decodedTables.constFind(overrideColorsSetting);
+    if (cached != s_decodedTables.constEnd()) {
+        return cached.value();
+    }
+
+    auto table = std::make_shared<ButtonOverrideColorTable>();
+
+    QJsonDocument document = QJsonDocument::fromJson(overrideColorsSetting.toUtf8());
     QJsonObject buttonStatesObject = document.object();
-    bool overrideColorLoaded = false;
 
     for (auto i = buttonStatesObject.begin(); i < buttonStatesObject.end(); i++) {
+        const int overridableButtonColorStatesIndex = overridableButtonColorStatesJsonStrings.indexOf(i.key());
+        if (overridableButtonColorStatesIndex < 0)
+            continue;
+
         QJsonArray colorArray = i->toArray();
+        ButtonOverrideColorEntry entry;
         QColor color;
         int colorOpacity;
-        int overridableButtonColorStatesIndex;
         int overrideColorItemsIndex;
         switch (colorArray.count()) {
         case 0:
         default:
-            break;
+            continue;
         case 1:
-            overridableButtonColorStatesIndex = overridableButtonColorStatesJsonStrings.indexOf(i.key());
-            if (overridableButtonColorStatesIndex < 0)
-                break;
-
-            overrideColorItemsIndex = overrideColorItems.indexOf(colorArray[0].toString());
-            if (overrideColorItemsIndex == 0)
-                break;
-
-            color = overrideColorItemsIndexToColor(_decorationColorsActive, _decorationColorsInactive, overrideColorItemsIndex, active);
-            if (!color.isValid())
-                break;
-
-            buttonOverrideColors.insert(static_cast<OverridableButtonColorState>(overridableButtonColorStatesIndex), color);
-            overrideColorLoaded = true;
-            break;
         case 2:
-            overridableButtonColorStatesIndex = overridableButtonColorStatesJsonStrings.indexOf(i.key());
-            if (overridableButtonColorStatesIndex < 0)
-                break;
-
             overrideColorItemsIndex = overrideColorItems.indexOf(colorArray[0].toString());
-            if (overrideColorItemsIndex == 0)
-                break;
-
-            color = overrideColorItemsIndexToColor(_decorationColorsActive, _decorationColorsInactive, overrideColorItemsIndex, active);
-            if (!color.isValid())
-                break;
-
-            colorOpacity = colorArray[1].toInt(-1);
-            if (colorOpacity >= 0 && colorOpacity <= 100) {
-                color.setAlphaF(colorOpacity / 100.0f);
-            } else {
-                break;
+            if (overrideColorItemsIndex <= 0)
+                continue;
+            entry.colorItemIndex = overrideColorItemsIndex;
+
+            if (colorArray.count() == 2) {
+                colorOpacity = colorArray[1].toInt(-1);
+                if (colorOpacity < 0 || colorOpacity > 100)
+                    continue;
+                entry.opacity = colorOpacity;
             }
-
-            buttonOverrideColors.insert(static_cast<OverridableButtonColorState>(overridableButtonColorStatesIndex), color);
-            overrideColorLoaded = true;
             break;
         case 3:
-            overridableButtonColorStatesIndex = overridableButtonColorStatesJsonStrings.indexOf(i.key());
-            if (overridableButtonColorStatesIndex < 0)
-                break;
-
             color.setRed(colorArray[0].toInt());
             color.setGreen(colorArray[1].toInt());
             color.setBlue(colorArray[2].toInt());
             if (!color.isValid())
-                break;
+                continue;
 
-            buttonOverrideColors.insert(static_cast<OverridableButtonColorState>(overridableButtonColorStatesIndex), color);
-            overrideColorLoaded = true;
+            entry.colorItemIndex = 0;
+            entry.customColor = color;
             break;
         case 4:
-            overridableButtonColorStatesIndex = overridableButtonColorStatesJsonStrings.indexOf(i.key());
-            if (overridableButtonColorStatesIndex < 0)
-                break;
-
             color.setRed(colorArray[1].toInt());
             color.setGreen(colorArray[2].toInt());
             color.setBlue(colorArray[3].toInt());
             if (!color.isValid())
-                break;
+                continue;
 
             colorOpacity = colorArray[0].toInt(-1);
-            if (colorOpacity >= 0 && colorOpacity <= 100) {
-                color.setAlphaF(colorOpacity / 100.0f);
-            } else {
-                break;
-            }
+            if (colorOpacity < 0 || colorOpacity > 100)
+                continue;
+            color.setAlphaF(colorOpacity / 100.0f);
 
-            buttonOverrideColors.insert(static_cast<OverridableButtonColorState>(overridableButtonColorStatesIndex), color);
-            overrideColorLoaded = true;
+            entry.colorItemIndex = 0;
+            entry.customColor = color;
             break;
         }
+
+        table->entries[overridableButtonColorStatesIndex] = entry;
+        table->present = true;
+    }
+
+    // stale strings from previous settings generations are dropped wholesale; tables already handed out stay alive while referenced
+    if (s_decodedTables.size() >= maxDecodedTables) {
+        s_decodedTables.clear();
     }
+    s_decodedTables.insert(overrideColorsSetting, table);
 
-    buttonOverrideColorsPresent = overrideColorLoaded;
+    return table;
 }
 
 QColor DecorationButtonPalette::overrideColorItemsIndexToColor(const DecorationPaletteGroup *decorationColorsActive,
@@ -429,7 +439,7 @@ void DecorationButtonPalette::generateTristateColors(ButtonComponent component,
 
 void DecorationButtonPalette::generateButtonBackgroundPalette(const bool active)
 {
-    DecorationButtonPaletteGroup *group = active ? this->_active.get() : this->_inactive.get();
+    DecorationButtonPaletteGroup *group = active ? &this->_active : &this->_inactive;
     QColor &backgroundNormal = group->backgroundNormal;
     QColor &backgroundHover = group->backgroundHover;
     QColor &backgroundPress = group->backgroundPress;
@@ -570,14 +580,14 @@ void DecorationButtonPalette::generateButtonBackgroundPalette(const bool active)
     if (buttonOverrideColorsPresent) {
         auto &buttonOverrideColors = active ? _buttonOverrideColorsActive : _buttonOverrideColorsInactive;
 
-        if (buttonOverrideColors.value(OverridableButtonColorState::BackgroundNormal).isValid() && drawBackgroundNormally) {
-            backgroundNormal = buttonOverrideColors.value(OverridableButtonColorState::BackgroundNormal);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::BackgroundNormal)].isValid() && drawBackgroundNormally) {
+            backgroundNormal = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::BackgroundNormal)];
         }
-        if (buttonOverrideColors.value(OverridableButtonColorState::BackgroundHover).isValid() && drawBackgroundOnHover) {
-            backgroundHover = buttonOverrideColors.value(OverridableButtonColorState::BackgroundHover);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::BackgroundHover)].isValid() && drawBackgroundOnHover) {
+            backgroundHover = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::BackgroundHover)];
         }
-        if (buttonOverrideColors.value(OverridableButtonColorState::BackgroundPress).isValid() && drawBackgroundOnPress) {
-            backgroundPress = buttonOverrideColors.value(OverridableButtonColorState::BackgroundPress);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::BackgroundPress)].isValid() && drawBackgroundOnPress) {
+            backgroundPress = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::BackgroundPress)];
         }
     }
 
@@ -601,7 +611,7 @@ void DecorationButtonPalette::generateButtonBackgroundPalette(const bool active)
 
 void DecorationButtonPalette::generateButtonForegroundPalette(const bool active)
 {
-    DecorationButtonPaletteGroup *group = active ? this->_active.get() : this->_inactive.get();
+    DecorationButtonPaletteGroup *group = active ? &this->_active : &this->_inactive;
     QColor &foregroundNormal = group->foregroundNormal;
     QColor &foregroundHover = group->foregroundHover;
     QColor &foregroundPress = group->foregroundPress;
@@ -797,14 +807,14 @@ void DecorationButtonPalette::generateButtonForegroundPalette(const bool active)
     const bool buttonOverrideColorsPresent = active ? _buttonOverrideColorsPresentActive : _buttonOverrideColorsPresentInactive;
     if (buttonOverrideColorsPresent) {
         auto &buttonOverrideColors = active ? _buttonOverrideColorsActive : _buttonOverrideColorsInactive;
-        if (buttonOverrideColors.value(OverridableButtonColorState::IconNormal).isValid() && drawIconNormally) {
-            foregroundNormal = buttonOverrideColors.value(OverridableButtonColorState::IconNormal);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::IconNormal)].isValid() && drawIconNormally) {
+            foregroundNormal = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::IconNormal)];
         }
-        if (buttonOverrideColors.value(OverridableButtonColorState::IconHover).isValid() && drawIconOnHover) {
-            foregroundHover = buttonOverrideColors.value(OverridableButtonColorState::IconHover);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::IconHover)].isValid() && drawIconOnHover) {
+            foregroundHover = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::IconHover)];
         }
-        if (buttonOverrideColors.value(OverridableButtonColorState::IconPress).isValid() && drawIconOnPress) {
-            foregroundPress = buttonOverrideColors.value(OverridableButtonColorState::IconPress);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::IconPress)].isValid() && drawIconOnPress) {
+            foregroundPress = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::IconPress)];
         }
     }
 
@@ -851,7 +861,7 @@ void DecorationButtonPalette::adjustPoorForegroundContrast(QColor &baseForegroun
 
 void DecorationButtonPalette::generateButtonOutlinePalette(const bool active)
 {
-    DecorationButtonPaletteGroup *group = active ? this->_active.get() : this->_inactive.get();
+    DecorationButtonPaletteGroup *group = active ? &this->_active : &this->_inactive;
     QColor &outlineNormal = group->outlineNormal;
     QColor &outlineHover = group->outlineHover;
     QColor &outlinePress = group->outlinePress;
@@ -985,14 +995,14 @@ void DecorationButtonPalette::generateButtonOutlinePalette(const bool active)
     const bool buttonOverrideColorsPresent = active ? _buttonOverrideColorsPresentActive : _buttonOverrideColorsPresentInactive;
     if (buttonOverrideColorsPresent) {
         auto &buttonOverrideColors = active ? _buttonOverrideColorsActive : _buttonOverrideColorsInactive;
-        if (buttonOverrideColors.value(OverridableButtonColorState::OutlineNormal).isValid() && drawOutlineNormally) {
-            outlineNormal = buttonOverrideColors.value(OverridableButtonColorState::OutlineNormal);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::OutlineNormal)].isValid() && drawOutlineNormally) {
+            outlineNormal = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::OutlineNormal)];
         }
-        if (buttonOverrideColors.value(OverridableButtonColorState::OutlineHover).isValid() && drawOutlineOnHover) {
-            outlineHover = buttonOverrideColors.value(OverridableButtonColorState::OutlineHover);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::OutlineHover)].isValid() && drawOutlineOnHover) {
+            outlineHover = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::OutlineHover)];
         }
-        if (buttonOverrideColors.value(OverridableButtonColorState::OutlinePress).isValid() && drawOutlineOnPress) {
-            outlinePress = buttonOverrideColors.value(OverridableButtonColorState::OutlinePress);
+        if (buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::OutlinePress)].isValid() && drawOutlineOnPress) {
+            outlinePress = buttonOverrideColors[static_cast<size_t>(OverridableButtonColorState::OutlinePress)];
         }
     }
 
@@ -8,9 +8,9 @@
 
 #include "breeze.h"
 #include "breezecommon_export.h"
-#include "decorationcolors.h"
 #include <KColorScheme>
 #include <QColor>
+#include <array>
 #include <memory>
 
 namespace Breeze
@@ -97,6 +97,23 @@ const QStringList overrideColorItems{
     QStringLiteral("WindowShadowInactive"),
 };
 
+//* one decoded entry of a button override colour JSON setting, independent of the decoration palette
+struct ButtonOverrideColorEntry {
+    //* index into overrideColorItems; 0 (Custom) means customColor is used, -1 means the state is not overridden
+    qint8 colorItemIndex = -1;
+    //* opacity in percent applied to a named colour item, or -1 to keep the item's own alpha
+    qint8 opacity = -1;
+    QColor customColor;
+};
+
+//* decoded button override colours for one button type and active state, indexed by OverridableButtonColorState
+struct ButtonOverrideColorTable {
+    std::array<ButtonOverrideColorEntry, static_cast<size_t>(OverridableButtonColorState::COUNT)> entries;
+    bool present = false;
+};
+
+using ButtonOverrideColors = std::array<QColor, static_cast<size_t>(OverridableButtonColorState::COUNT)>;
+
 struct BREEZECOMMON_EXPORT DecorationButtonPaletteGroup {
     QColor foregroundPress;
     QColor foregroundHover;
@@ -132,11 +149,11 @@ public:
                   const bool oneGroupActiveState = true);
     const DecorationButtonPaletteGroup *active() const
     {
-        return _active.get();
+        return &_active;
     }
     const DecorationButtonPaletteGroup *inactive() const
     {
-        return _inactive.get();
+        return &_inactive;
     }
 
     DecorationButtonType buttonType()
@@ -144,11 +161,23 @@ public:
         return _buttonType;
     }
 
+    //* unique number of the last generate() call on this palette, so users can tell when colours derived from it are out of date
+    quint64 generation() const
+    {
+        return _generation;
+    }
+
     static QColor overrideColorItemsIndexToColor(const DecorationPaletteGroup *decorationColorsActive,
                                                  const DecorationPaletteGroup *decorationColorsInactive,
                                                  const int overrideColorItemsIndex,
                                                  const bool active);
 
+    /**
+     * @brief Returns the decoded table for a buttonOverrideColorsActive/Inactive JSON setting.
+     *        Each distinct setting string is parsed only once; the table is shared by every palette of every decoration using those settings.
+     */
+    static std::shared_ptr<const ButtonOverrideColorTable> decodedButtonOverrideColorTable(const QString &overrideColorsSetting);
+
 private:
     void decodeButtonOverrideColors(const bool active);
     void generateBistateColors(ButtonComponent component,
@@ -175,17 +204,19 @@ private:
 
     InternalSettingsPtr _decorationSettings;
     DecorationButtonType _buttonType;
+    quint64 _generation = 0;
     const DecorationPaletteGroup *_decorationColorsActive;
     const DecorationPaletteGroup *_decorationColorsInactive;
 
     bool _buttonOverrideColorsPresentActive{false};
     bool _buttonOverrideColorsPresentInactive{false};
 
-    QMap<OverridableButtonColorState, QColor> _buttonOverrideColorsActive;
-    QMap<OverridableButtonColorState, QColor> _buttonOverrideColorsInactive;
+    ButtonOverrideColors _buttonOverrideColorsActive;
+    ButtonOverrideColors _buttonOverrideColorsInactive;
 
-    std::shared_ptr<DecorationButtonPaletteGroup> _active;
-    std::shared_ptr<DecorationButtonPaletteGroup> _inactive;
+    //* stored inline so that the active and inactive normal/hover/press colours of a button type are contiguous
+    DecorationButtonPaletteGroup _active;
+    DecorationButtonPaletteGroup _inactive;
 };
 
 }
@@ -7,6 +7,7 @@
 #include "colortools.h"
 #include <KColorUtils>
 #include <KStatefulBrush>
+#include <algorithm>
 
 namespace Breeze
 {
@@ -14,7 +15,7 @@ namespace Breeze
 QPalette DecorationColors::s_cachedKdeGlobalPalette;
 std::unique_ptr<DecorationPaletteGroup> DecorationColors::s_cachedDecorationPaletteGroupActive;
 std::unique_ptr<DecorationPaletteGroup> DecorationColors::s_cachedDecorationPaletteGroupInactive;
-std::map<DecorationButtonType, DecorationButtonPalette> DecorationColors::s_cachedButtonPalettes;
+DecorationButtonPalettes DecorationColors::s_cachedButtonPalettes;
 QByteArray DecorationColors::s_settingsUpdateUuid = "";
 bool DecorationColors::s_cachedColorsGenerated = false;
 
@@ -41,25 +42,35 @@ DecorationColors::DecorationColors(const bool useCachedPalette, const bool forAp
         *m_decorationPaletteGroupInactive = std::make_unique<DecorationPaletteGroup>();
     }
 
-    if (!m_buttonPalettes->size() && !m_forAppStyle) { // appStyle should generate buttons separately
+    const bool buttonPalettesInitialized = std::any_of(m_buttonPalettes->palettes.cbegin(), m_buttonPalettes->palettes.cend(), [](const auto &palette) {
+        return palette.has_value();
+    });
+    if (!buttonPalettesInitialized && !m_forAppStyle) { // appStyle should generate buttons separately
         const QList<DecorationButtonType> &coloredButtonTypes = m_forAppStyle ? coloredAppStyleDecorationButtonTypes : coloredWindowDecorationButtonTypes;
 
-        // initialise m_buttonPalettes map so that only generate() needs called later -- ensures the values in the map are at the same memory location
+        // initialise m_buttonPalettes so that only generate() needs called later -- the palettes live in place in the array, so their addresses stay fixed
         for (int i = 0; i < coloredButtonTypes.count(); i++) {
-            DecorationButtonPalette buttonPalette(coloredButtonTypes[i]);
-            m_buttonPalettes->insert({coloredButtonTypes[i], buttonPalette});
+            m_buttonPalettes->palettes[static_cast<size_t>(coloredButtonTypes[i])].emplace(coloredButtonTypes[i]);
         }
     }
 }
 
 DecorationButtonPalette *DecorationColors::buttonPalette(DecorationButtonType type) const
 {
-    auto it = m_buttonPalettes->find(type);
-    if (it != m_buttonPalettes->end()) {
-        return &(it->second);
-    } else {
+    const size_t index = static_cast<size_t>(type);
+    if (index >= m_buttonPalettes->palettes.size() || !m_buttonPalettes->palettes[index]) {
         return nullptr;
     }
+
+    DecorationButtonPalette &palette = *m_buttonPalettes->palettes[index];
+    quint8 &staleGroups = m_buttonPalettes->staleGroups[index];
+    if (staleGroups) {
+        const bool staleActive = staleGroups & DecorationButtonPalettes::StaleActive;
+        const bool staleInactive = staleGroups & DecorationButtonPalettes::StaleInactive;
+        palette.generate(m_buttonPalettes->decorationSettings, active(), inactive(), !(staleActive && staleInactive), staleActive);
+        staleGroups = 0;
+    }
+    return &palette;
 }
 
 void DecorationColors::generateDecorationColors(const QPalette &palette,
@@ -106,8 +117,14 @@ void DecorationColors::generateDecorationAndButtonColors(const QPalette &palette
                              titleBarBaseInactive,
                              settingsUpdateUuid);
 
-    for (auto i = m_buttonPalettes->begin(); i != m_buttonPalettes->end(); i++) {
-        i->second.generate(decorationSettings, this->active(), this->inactive(), generateOneGroupOnly, oneGroupActiveState);
+    // button palettes are only generated when first requested through buttonPalette(), so types absent from the button layout cost nothing
+    quint8 staleGroups = DecorationButtonPalettes::StaleActive | DecorationButtonPalettes::StaleInactive;
+    if (generateOneGroupOnly) {
+        staleGroups = oneGroupActiveState ? DecorationButtonPalettes::StaleActive : DecorationButtonPalettes::StaleInactive;
+    }
+    m_buttonPalettes->decorationSettings = decorationSettings;
+    for (quint8 &paletteStaleGroups : m_buttonPalettes->staleGroups) {
+        paletteStaleGroups |= staleGroups;
     }
 }
 
@@ -13,8 +13,9 @@
 #include <QColor>
 #include <QObject>
 #include <QPalette>
-#include <map>
+#include <array>
 #include <memory>
+#include <optional>
 
 namespace Breeze
 {
@@ -42,6 +43,18 @@ struct BREEZECOMMON_EXPORT DecorationPaletteGroup {
     QColor positiveSaturated;
 };
 
+//* button palettes indexed by DecorationButtonType, generated lazily on first access after each colour regeneration
+struct DecorationButtonPalettes {
+    enum StaleGroup : quint8 { StaleActive = 0x1, StaleInactive = 0x2 };
+
+    //* types without a coloured palette (e.g. Spacer) are left empty
+    std::array<std::optional<DecorationButtonPalette>, static_cast<size_t>(DecorationButtonType::COUNT)> palettes;
+    //* StaleGroup flags of the palette groups that still need generating
+    std::array<quint8, static_cast<size_t>(DecorationButtonType::COUNT)> staleGroups{};
+    //* settings to generate stale palettes with
+    QSharedPointer<InternalSettings> decorationSettings;
+};
+
 extern qreal BREEZECOMMON_EXPORT g_translucentButtonBackgroundsOpacityActive;
 extern qreal BREEZECOMMON_EXPORT g_translucentButtonBackgroundsOpacityInactive;
 
@@ -70,6 +83,7 @@ public:
         return (m_decorationPaletteGroupInactive->get());
     }
 
+    //* returns the palette for the button type, generating it first if the colours were regenerated since it was last requested
     DecorationButtonPalette *buttonPalette(DecorationButtonType type) const;
 
     bool isCachedPalette()
@@ -177,7 +191,7 @@ private:
     QPalette *m_basePalette;
     std::unique_ptr<DecorationPaletteGroup> *m_decorationPaletteGroupActive;
     std::unique_ptr<DecorationPaletteGroup> *m_decorationPaletteGroupInactive;
-    std::map<DecorationButtonType, DecorationButtonPalette> *m_buttonPalettes;
+    DecorationButtonPalettes *m_buttonPalettes;
     bool *m_colorsGenerated;
     void *m_settingsUpdateUuid;
 
@@ -185,14 +199,14 @@ private:
     QPalette m_nonCachedClientPalette;
     std::unique_ptr<DecorationPaletteGroup> m_nonCachedDecorationPaletteGroupActive;
     std::unique_ptr<DecorationPaletteGroup> m_nonCachedDecorationPaletteGroupInactive;
-    std::map<DecorationButtonType, DecorationButtonPalette> m_nonCachedButtonPalettes;
+    DecorationButtonPalettes m_nonCachedButtonPalettes;
     bool m_nonCachedColorsGenerated = false;
 
     //* cached data used for window decorations
     static QPalette s_cachedKdeGlobalPalette;
     static std::unique_ptr<DecorationPaletteGroup> s_cachedDecorationPaletteGroupActive;
     static std::unique_ptr<DecorationPaletteGroup> s_cachedDecorationPaletteGroupInactive;
-    static std::map<DecorationButtonType, DecorationButtonPalette> s_cachedButtonPalettes;
+    static DecorationButtonPalettes s_cachedButtonPalettes;
     static QByteArray s_settingsUpdateUuid;
     static bool s_cachedColorsGenerated;
 };
@@ -5,9 +5,37 @@
  */
 #include "geometrytools.h"
 
+#include <QCache>
+#include <QVector>
+#include <QtMath>
+
 namespace Breeze
 {
 
+//* the horizontal inset of each pixel row of a rounded corner, from the outermost row inwards, for pixel centres inside the arc
+static QVector<int> cornerRowInsets(qreal radius)
+{
+    // keyed by radius in 1/64ths of a pixel, there are only ever a few radii in use
+    static QCache<int, QVector<int>> cache(16);
+
+    const int key = qRound(radius * 64);
+    if (QVector<int> *insets = cache.object(key)) {
+        return *insets;
+    }
+
+    QVector<int> insets;
+    const int rows = qCeil(radius);
+    insets.reserve(rows);
+    for (int y = 0; y < rows; ++y) {
+        const qreal dy = radius - (y + 0.5);
+        const qreal inset = dy > 0 ? radius - qSqrt(radius * radius - dy * dy) : 0;
+        insets.append(qMax(0, qCeil(inset - 0.5)));
+    }
+
+    cache.insert(key, new QVector<int>(insets));
+    return insets;
+}
+
 // from breezehelper.cpp
 QPainterPath GeometryTools::roundedPath(const QRectF &rect, Corners corners, qreal radius)
 {
@@ -67,4 +95,56 @@ QPainterPath GeometryTools::roundedPath(const QRectF &rect, Corners corners, qre
     return path;
 }
 
+//________________________________________________________________
+QRegion GeometryTools::roundedRegion(const QRect &rect, Corners corners, qreal radius)
+{
+    if (corners == 0 || radius <= 0) {
+        return QRegion(rect);
+    }
+
+    const QVector<int> insets = cornerRowInsets(radius);
+    const int cornerRows = qMin(int(insets.size()), rect.height() / 2);
+
+    QRegion region;
+
+    // adds the rows [firstRow, lastRow] of the rect, merging consecutive rows with equal insets into one rectangle
+    auto addRows = [&](int firstRow, int lastRow, Corner leftCorner, Corner rightCorner, bool bottom) {
+        int bandTop = firstRow;
+        int bandLeft = 0;
+        int bandRight = 0;
+        for (int row = firstRow; row <= lastRow + 1; ++row) {
+            int left = 0;
+            int right = 0;
+            if (row <= lastRow) {
+                const int inset = insets[bottom ? rect.height() - 1 - row : row];
+                left = corners & leftCorner ? inset : 0;
+                right = corners & rightCorner ? inset : 0;
+            }
+
+            if (row == firstRow) {
+                bandLeft = left;
+                bandRight = right;
+            } else if (row > lastRow || left != bandLeft || right != bandRight) {
+                region += QRect(rect.left() + bandLeft, rect.top() + bandTop, rect.width() - bandLeft - bandRight, row - bandTop);
+                bandTop = row;
+                bandLeft = left;
+                bandRight = right;
+            }
+        }
+    };
+
+    if (cornerRows > 0) {
+        addRows(0, cornerRows - 1, CornerTopLeft, CornerTopRight, false);
+    }
+
+    // straight edges
+    region += QRect(rect.left(), rect.top() + cornerRows, rect.width(), rect.height() - 2 * cornerRows);
+
+    if (cornerRows > 0) {
+        addRows(rect.height() - cornerRows, rect.height() - 1, CornerBottomLeft, CornerBottomRight, true);
+    }
+
+    return region;
+}
+
 }
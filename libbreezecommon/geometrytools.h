@@ -10,6 +10,7 @@
 #include "breezecommon_export.h"
 
 #include <QPainterPath>
+#include <QRegion>
 
 namespace Breeze
 {
@@ -22,6 +23,13 @@ class BREEZECOMMON_EXPORT GeometryTools
 {
 public:
     static QPainterPath roundedPath(const QRectF &rect, Corners corners, qreal radius);
+
+    /**
+     * @brief Returns the pixels covered by roundedPath() as a region, without rasterizing a path.
+     *        The region is assembled from a cached stack of row rectangles per corner radius, plus the straight edges, so a
+     *        resize only moves the rectangles.
+     */
+    static QRegion roundedRegion(const QRect &rect, Corners corners, qreal radius);
 };
 
 }
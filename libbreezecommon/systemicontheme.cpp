@@ -6,45 +6,117 @@
 
 #include "systemicontheme.h"
 #include "colortools.h"
+#if HAVE_QTDBUS
+#include "dbusupdatenotifier.h"
+#endif
 #include <KIconLoader>
+#include <QCache>
+#include <QHashFunctions>
 #include <QIcon>
 
 namespace Breeze
 {
 
+//* identifies one final, tinted system theme icon pixmap
+struct SystemIconCacheKey {
+    QString iconName;
+    //* icon size in device pixels
+    int deviceIconSize = 0;
+    //* device pixel ratio, in 1/1000ths
+    int devicePixelRatio = 0;
+    QRgb tintColor = 0;
+    //* hash of the palette roles KIconLoader recolours symbolic icons with; 0 when the icon is force-colourized
+    size_t paletteHash = 0;
+    bool forceColorize = false;
+
+    bool operator==(const SystemIconCacheKey &other) const = default;
+};
+
+static size_t qHash(const SystemIconCacheKey &key, size_t seed = 0)
+{
+    seed = hashCombine(seed, qHash(key.iconName));
+    seed = hashCombine(seed, qHash(key.deviceIconSize));
+    seed = hashCombine(seed, qHash(key.devicePixelRatio));
+    seed = hashCombine(seed, qHash(key.tintColor));
+    seed = hashCombine(seed, qHash(key.paletteHash));
+    return hashCombine(seed, qHash(int(key.forceColorize)));
+}
+
+//* maximum size of the system icon cache, in KiB
+static constexpr int systemIconCacheMaxCost = 4 * 1024;
+
+//* process-wide cache of system icon pixmaps, flushed when the icon theme changes
+static QCache<SystemIconCacheKey, QPixmap> &systemIconCache()
+{
+    static QCache<SystemIconCacheKey, QPixmap> cache(systemIconCacheMaxCost);
+#if HAVE_QTDBUS
+    static const QMetaObject::Connection flushConnection =
+        QObject::connect(&g_dBusUpdateNotifier, &DBusUpdateNotifier::systemIconsUpdate, &g_dBusUpdateNotifier, &SystemIconTheme::clearCache);
+    Q_UNUSED(flushConnection);
+#endif
+    return cache;
+}
+
+void SystemIconTheme::clearCache()
+{
+    systemIconCache().clear();
+}
+
 void SystemIconTheme::paintIconFromSystemTheme(QString iconName)
 {
     QColor color = m_painter->pen().color();
+    const bool forceColorize = m_internalSettings->forceColorizeSystemIcons();
+    const qreal devicePixelRatio = m_painter->device()->devicePixelRatioF();
+    int m_iconWidthScaled = qRound(m_iconWidth * devicePixelRatio);
+    QSize pixmapSize(m_iconWidth, m_iconWidth);
+    QRect rect(QPoint(0, 0), pixmapSize);
+
+    SystemIconCacheKey key;
+    key.iconName = iconName;
+    key.deviceIconSize = m_iconWidthScaled;
+    key.devicePixelRatio = qRound(devicePixelRatio * 1000);
+    key.tintColor = color.rgba();
+    key.forceColorize = forceColorize;
+    if (!forceColorize) {
+        key.paletteHash = hashCombine(hashCombine(qHash(m_palette.color(QPalette::Window).rgba()), qHash(m_palette.color(QPalette::Highlight).rgba())),
+                                      qHash(m_palette.color(QPalette::HighlightedText).rgba()));
+    }
+
+    QCache<SystemIconCacheKey, QPixmap> &cache = systemIconCache();
+    if (QPixmap *cachedPixmap = cache.object(key)) {
+        m_painter->drawPixmap(rect, *cachedPixmap);
+        return;
+    }
 
     KIconLoader *iconLoader = KIconLoader::global();
     QPalette originalPalette;
-    if (!m_internalSettings->forceColorizeSystemIcons()) {
+    if (!forceColorize) {
         originalPalette = iconLoader->customPalette();
         m_palette.setColor(QPalette::WindowText, color);
         iconLoader->setCustomPalette(m_palette);
     }
 
-    int m_iconWidthScaled = qRound(m_iconWidth * m_painter->device()->devicePixelRatioF());
     QPixmap iconPixmap = iconLoader->loadIcon(iconName, KIconLoader::Group::NoGroup, m_iconWidthScaled);
-    iconPixmap.setDevicePixelRatio(m_painter->device()->devicePixelRatioF());
-    QSize pixmapSize(m_iconWidth, m_iconWidth);
-    QRect rect(QPoint(0, 0), pixmapSize);
+    iconPixmap.setDevicePixelRatio(devicePixelRatio);
 
-    if (m_internalSettings->forceColorizeSystemIcons()) {
+    if (forceColorize) {
         // convert the alpha of the icon into tinted colour on transparent
         QImage iconImage(iconPixmap.toImage());
         ColorTools::convertAlphaToColor(iconImage, color);
-
-        m_painter->drawImage(rect, iconImage);
+        iconPixmap = QPixmap::fromImage(iconImage);
     } else {
-        m_painter->drawPixmap(rect, iconPixmap);
-
         if (originalPalette == QPalette()) {
             iconLoader->resetPalette();
         } else {
             iconLoader->setCustomPalette(originalPalette);
         }
     }
+
+    m_painter->drawPixmap(rect, iconPixmap);
+
+    // cost is the pixmap size in KiB, rounded up
+    const qsizetype cost = qsizetype(iconPixmap.width()) * iconPixmap.height() * 4 / 1024 + 1;
+    cache.insert(key, new QPixmap(iconPixmap), cost);
 }
 
 void SystemIconTheme::renderIcon()
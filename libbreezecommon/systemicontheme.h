@@ -38,8 +38,12 @@ public:
         , m_internalSettings(internalSettings)
         , m_palette(palette){};
 
+    //* paints the icon, loading and tinting it only if it is not already in the shared pixmap cache
     void renderIcon();
 
+    //* flush the shared cache of loaded and tinted system icon pixmaps
+    static void clearCache();
+
     //* When "Use system icon theme" is selected for the icons then not all icons are available as a window-*-symbolic icon
     //* ouputs systemIconName and systemIconCheckedName
     static void systemIconNames(DecorationButtonType type, QString &systemIconName, QString &systemIconCheckedName);